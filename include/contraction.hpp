@@ -0,0 +1,154 @@
+#ifndef CONTRACTION_H_
+#define CONTRACTION_H_
+
+#include "operations.hpp"
+#include <Eigen/Core>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * \brief Plans of einsum-style tensor contractions
+ *
+ * A contraction like "Pij,jk->Pik" is planned once for the shapes of its
+ * operands and executed by a `CudaPipeline` or a `CpuPipeline`. The tensors
+ * are dense with their first index running fastest, like Eigen::Tensor, so
+ * a matrix is a rank 2 tensor with the same buffer.
+ *
+ * The planner contracts the operands pairwise, picking greedily the cheapest
+ * pair. Every pair becomes a single batched gemm: indices shared by both
+ * operands and still needed afterwards are batched, the other shared ones
+ * are contracted. Operands are only permuted when no transposition of the
+ * gemm reaches the required layout.
+ */
+
+namespace eigencuda {
+
+using Index = Eigen::Index;
+class CudaMatrix;
+
+// Dimensions of a tensor, the first one runs fastest
+using Shape = std::vector<Index>;
+
+// Product of the dimensions, 1 for a scalar
+Index shape_size(const Shape &shape);
+
+// A tensor stored in a matrix type: its buffer reinterpreted with `shape`.
+// By default the matrix is its own rank 2 tensor
+template <typename Matrix>
+struct TensorOperand {
+  TensorOperand(const Matrix &matrix)
+      : matrix{matrix}, shape{matrix.rows(), matrix.cols()} {};
+  TensorOperand(const Matrix &matrix, Shape shape)
+      : matrix{matrix}, shape{std::move(shape)} {};
+  // The operand only refers to the matrix, which must outlive it
+  TensorOperand(Matrix &&matrix) = delete;
+  TensorOperand(Matrix &&matrix, Shape shape) = delete;
+
+  const Matrix &matrix;
+  Shape shape;
+};
+
+using CudaOperand = TensorOperand<CudaMatrix>;
+using HostOperand = TensorOperand<Eigen::MatrixXd>;
+
+// Elementary operation of a plan. Slots [0, number of inputs) hold the
+// operands and the following ones the intermediate results.
+struct ContractionStep {
+  enum class Kind {
+    Permute,  // output index d is input index permutation[d]
+    Sum,      // sum the trailing k dimensions of an m x k matrix
+    Gemm      // batch products of an m x k and a k x n matrix
+  };
+  Kind kind;
+  int input;
+  int other = -1;  // second operand of the gemm
+  int output;
+
+  // Permute
+  Shape dims;
+  std::vector<int> permutation;
+
+  // Sum and Gemm, the batches are stored one after the other
+  Index m = 1;
+  Index n = 1;
+  Index k = 1;
+  Index batch = 1;
+  Operation op_A = Operation::None;
+  Operation op_B = Operation::None;
+};
+
+class ContractionPlan {
+ public:
+  // Highest rank supported by the permutations
+  static constexpr int max_rank = 8;
+
+  // Parse the expression and plan it for the shapes of its operands. Indices
+  // are single letters; without "->" the result keeps the indices appearing
+  // once, in alphabetical order
+  ContractionPlan(const std::string &expression,
+                  const std::vector<Shape> &shapes);
+
+  const std::vector<Shape> &input_shapes() const { return _input_shapes; };
+  const Shape &result_shape() const { return _result_shape; };
+  const std::vector<ContractionStep> &steps() const { return _steps; };
+
+  // Number of elements of every slot and the slot holding the result
+  const std::vector<Index> &slot_sizes() const { return _slot_sizes; };
+  int result_slot() const { return int(_slot_sizes.size()) - 1; };
+
+  // Floating point operations of the whole plan
+  double flops() const { return _flops; };
+
+  // The result is returned as a matrix whose rows are the first index
+  Index result_rows() const;
+  Index result_cols() const;
+
+  // Raise an error unless the shapes are the planned ones
+  void throw_if_incompatible(const std::vector<Shape> &shapes) const;
+
+  friend std::ostream &operator<<(std::ostream &os,
+                                  const ContractionPlan &plan);
+
+ private:
+  struct Node {
+    std::string labels;
+    int slot;
+  };
+
+  void parse(const std::string &expression);
+  void plan();
+
+  Shape dims_of(const std::string &labels) const;
+  Index size_of(const std::string &labels) const;
+  // Whether `label` is in the result or in a node other than `skip`
+  bool is_needed(char label, const std::vector<Node> &nodes,
+                 const std::vector<int> &skip) const;
+
+  // Emit the steps, returning the resulting node
+  Node permute(const Node &node, const std::string &labels);
+  Node sum(const Node &node, const std::string &summed);
+  Node contract(const Node &A, const Node &B, const std::vector<Node> &nodes,
+                const std::vector<int> &pair);
+  int new_slot(Index size);
+
+  std::vector<std::string> _input_labels;
+  std::string _result_labels;
+  std::vector<Shape> _input_shapes;
+  Shape _result_shape;
+  // Dimension of every letter, negative when unused
+  std::vector<Index> _dims = std::vector<Index>(128, -1);
+
+  std::vector<ContractionStep> _steps;
+  std::vector<Index> _slot_sizes;
+  double _flops = 0;
+};
+
+// Host reference of the permutation kernel: B(d_0, ..., d_r) = A(...) with
+// output index d taken from input index permutation[d]
+void permute(const double *A, const Shape &dims,
+             const std::vector<int> &permutation, double *B);
+
+}  // namespace eigencuda
+
+#endif  // CONTRACTION_H_
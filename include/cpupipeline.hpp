@@ -0,0 +1,185 @@
+#ifndef CPU_PIPELINE_H_
+#define CPU_PIPELINE_H_
+
+#include "contraction.hpp"
+#include "matrixchain.hpp"
+#include "operations.hpp"
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <cstdint>
+#include <vector>
+
+/*
+ * \brief Host counterpart of `CudaPipeline`
+ *
+ * The `CpuPipeline` exposes the same operations as the `CudaPipeline` over
+ * `Eigen::MatrixXd`, using Eigen's vectorized kernels. It is the CPU path of
+ * the algorithms and the reference of the device results.
+ */
+
+namespace eigencuda {
+
+class CpuPipeline {
+ public:
+  // C = A * B
+  void gemm(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+            Eigen::MatrixXd &C) const;
+
+  // C_i = A_i * B_i for `batch` pairs of matrices stored side by side, like
+  // CudaTensor::matrix(). Square matrices up to 32 x 32 use fixed-size Eigen
+  // products unrolled and vectorized at compile time
+  void gemm_batched(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                    Eigen::MatrixXd &C, Eigen::Index batch) const;
+
+  // Emulation of CudaPipeline::gemm_split with the same slices and exact
+  // single precision products, to measure the accuracy of a bits target
+  void gemm_split(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                  Eigen::MatrixXd &C, int bits = 53,
+                  SplitArithmetic arithmetic = SplitArithmetic::Single) const;
+
+  // y = alpha * op(A) * x + beta * y
+  void gemv(const Eigen::MatrixXd &A, const Eigen::VectorXd &x,
+            Eigen::VectorXd &y, double alpha = 1., double beta = 0.,
+            Operation op = Operation::None) const;
+  // Apply op(A) to every column of X
+  void gemv_batched(const Eigen::MatrixXd &A, const Eigen::MatrixXd &X,
+                    Eigen::MatrixXd &Y,
+                    Operation op = Operation::None) const;
+
+  // Sparse times dense products using Eigen's sparse kernels
+  // C = alpha * op(A) * B + beta * C
+  void spmm(const Eigen::SparseMatrix<double> &A, const Eigen::MatrixXd &B,
+            Eigen::MatrixXd &C, double alpha = 1., double beta = 0.,
+            Operation op = Operation::None) const;
+  // y = alpha * op(A) * x + beta * y
+  void spmv(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &x,
+            Eigen::VectorXd &y, double alpha = 1., double beta = 0.,
+            Operation op = Operation::None) const;
+
+  // Tensor contractions executing the same plans as the CudaPipeline
+  void einsum(const std::string &expression,
+              const std::vector<HostOperand> &operands,
+              Eigen::MatrixXd &result) const;
+  void contract(const ContractionPlan &plan,
+                const std::vector<HostOperand> &operands,
+                Eigen::MatrixXd &result) const;
+
+  // Matrix chain products executing the same plans as the CudaPipeline
+  void chain_product(const ChainOperands<Eigen::MatrixXd> &operands,
+                     Eigen::MatrixXd &result) const;
+  void chain_product(const ChainPlan &plan,
+                     const ChainOperands<Eigen::MatrixXd> &operands,
+                     Eigen::MatrixXd &result) const;
+
+  // Element-wise operations
+  // A = alpha * A
+  void scale(Eigen::MatrixXd &A, double alpha) const;
+  // Y = alpha * X + Y
+  void axpy(double alpha, const Eigen::MatrixXd &X, Eigen::MatrixXd &Y) const;
+  // C = A + B
+  void add(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+           Eigen::MatrixXd &C) const;
+  // C = A .* B
+  void hadamard_product(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                        Eigen::MatrixXd &C) const;
+  // C = A ./ B
+  void hadamard_division(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                         Eigen::MatrixXd &C) const;
+  // A = f(A)
+  void apply(Eigen::MatrixXd &A, UnaryFunction function) const;
+  // Same sequences as CudaPipeline::random. Uniform numbers are bitwise
+  // identical, normal ones up to the rounding of the device math functions
+  void random(Eigen::MatrixXd &A, Distribution distribution,
+              std::uint64_t seed, std::uint64_t subsequence = 0) const;
+
+  // Reductions
+  double norm(const Eigen::MatrixXd &A, Norm type = Norm::Frobenius) const;
+  double sum(const Eigen::MatrixXd &A) const;
+  double trace(const Eigen::MatrixXd &A) const;
+  // sum(A .* B)
+  double dot(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B) const;
+  Eigen::VectorXd column_norms(const Eigen::MatrixXd &A) const;
+
+  // Eigenvalues (ascending) and eigenvectors (columns) of the symmetric
+  // matrix A, using its lower triangle. When LAPACK is found at configure
+  // time they call dsyevd and dsyevr, multithreaded with a threaded BLAS
+  // such as OpenBLAS, otherwise Eigen's sequential SelfAdjointEigenSolver
+  void syevd(const Eigen::MatrixXd &A, Eigen::MatrixXd &eigenvalues,
+             Eigen::MatrixXd &eigenvectors) const;
+  // Only the `count` eigenpairs starting from the `first` lowest one, the
+  // others are not computed with LAPACK
+  void syevdx(const Eigen::MatrixXd &A, Eigen::Index first, Eigen::Index count,
+              Eigen::MatrixXd &eigenvalues,
+              Eigen::MatrixXd &eigenvectors) const;
+
+  // Truncated SVD A ~ U * diag(S) * V^T by the randomized range finder,
+  // sketching with the same random numbers as CudaPipeline::randomized_svd
+  void randomized_svd(const Eigen::MatrixXd &A, Eigen::Index rank,
+                      Eigen::MatrixXd &U, Eigen::MatrixXd &S,
+                      Eigen::MatrixXd &V, Eigen::Index oversampling = 10,
+                      Eigen::Index power_iterations = 2,
+                      std::uint64_t seed = 0) const;
+
+  // Symmetric products computing only `triangle` of C, Triangle::Full
+  // mirrors the lower triangle into the upper one.
+  // C = op(A) * op(A)^T, the Gram matrix A^T * A by default
+  void syrk(const Eigen::MatrixXd &A, Eigen::MatrixXd &C,
+            Triangle triangle = Triangle::Full,
+            Operation op = Operation::Transpose) const;
+  // C = op(A) * op(B)^T + op(B) * op(A)^T
+  void syr2k(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+             Eigen::MatrixXd &C, Triangle triangle = Triangle::Full,
+             Operation op = Operation::Transpose) const;
+  // C = A * B (left) or C = B * A (right) using the lower triangle of the
+  // symmetric matrix A
+  void symm(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+            Eigen::MatrixXd &C, Side side = Side::Left) const;
+
+  // Triangular solves and products using only `triangle` of A
+  // B = alpha * op(A)^-1 * B (left) or B = alpha * B * op(A)^-1 (right)
+  void trsm(const Eigen::MatrixXd &A, Eigen::MatrixXd &B,
+            Side side = Side::Left, Triangle triangle = Triangle::Lower,
+            Operation op = Operation::None,
+            Diagonal diagonal = Diagonal::NonUnit, double alpha = 1.) const;
+  // C = alpha * op(A) * B (left) or C = alpha * B * op(A) (right)
+  void trmm(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+            Eigen::MatrixXd &C, Side side = Side::Left,
+            Triangle triangle = Triangle::Lower,
+            Operation op = Operation::None,
+            Diagonal diagonal = Diagonal::NonUnit, double alpha = 1.) const;
+
+  // Cholesky factorization of the symmetric positive definite matrix A,
+  // using its lower triangle
+  Eigen::LLT<Eigen::MatrixXd> potrf(const Eigen::MatrixXd &A) const;
+  // Overwrite B with the solution X of A * X = B
+  void potrs(const Eigen::LLT<Eigen::MatrixXd> &factor,
+             Eigen::MatrixXd &B) const;
+
+  // LU factorization with partial pivoting of the square matrix A
+  Eigen::PartialPivLU<Eigen::MatrixXd> getrf(const Eigen::MatrixXd &A) const;
+  // Overwrite B with the solution X of A * X = B
+  void getrs(const Eigen::PartialPivLU<Eigen::MatrixXd> &factor,
+             Eigen::MatrixXd &B) const;
+
+  // Batched factorizations of `batch` square matrices stored side by side,
+  // like CudaTensor::matrix(), spread over the threads. The right hand sides
+  // of the solves are side by side too. The factorizations throw naming the
+  // first matrix that is not positive definite or singular
+  std::vector<Eigen::LLT<Eigen::MatrixXd>> potrf_batched(
+      const Eigen::MatrixXd &A, Eigen::Index batch) const;
+  void potrs_batched(const std::vector<Eigen::LLT<Eigen::MatrixXd>> &factors,
+                     Eigen::MatrixXd &B) const;
+  std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> getrf_batched(
+      const Eigen::MatrixXd &A, Eigen::Index batch) const;
+  void getrs_batched(
+      const std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> &factors,
+      Eigen::MatrixXd &B) const;
+  // Sizes that are multiples of 8 up to 64 use fixed-size Eigen types
+  void inverse_batched(const Eigen::MatrixXd &A, Eigen::MatrixXd &inverse,
+                       Eigen::Index batch) const;
+};
+
+}  // namespace eigencuda
+
+#endif  // CPU_PIPELINE_H_
@@ -0,0 +1,279 @@
+#ifndef CUDA_EXPRESSION_H_
+#define CUDA_EXPRESSION_H_
+
+#include "cudapipeline.hpp"
+#include <deque>
+
+/*
+ * \brief Lazy expressions over `CudaMatrix`
+ *
+ * Writing `A * B + 2. * C` builds an expression tree without touching the
+ * device. `evaluate` flattens the tree into a sum of scaled terms and runs it
+ * with the minimal number of cublas calls, folding the scalars and additions
+ * into the alpha/beta arguments of gemm and geam. The factors of a nested
+ * product such as `A * B * C` are materialized first, in temporaries taken
+ * from the workspace of the pipeline when one is reserved.
+ */
+
+namespace eigencuda {
+
+// alpha * op(A) * op(B), or alpha * op(A) when there is no B
+struct Term {
+  double alpha;
+  const CudaMatrix *A;
+  Operation op_A;
+  const CudaMatrix *B;
+  Operation op_B;
+
+  bool is_product() const { return B != nullptr; };
+  Index rows() const {
+    return (op_A == Operation::None) ? A->rows() : A->cols();
+  };
+  Index cols() const {
+    const CudaMatrix *last = is_product() ? B : A;
+    Operation op = is_product() ? op_B : op_A;
+    return (op == Operation::None) ? last->cols() : last->rows();
+  };
+};
+
+// Nested products evaluated while collecting the terms of an expression,
+// they live until the whole expression is evaluated
+class Temporaries {
+ public:
+  explicit Temporaries(const CudaPipeline &pipeline);
+
+  Temporaries(const Temporaries &) = delete;
+  Temporaries &operator=(const Temporaries &) = delete;
+
+  CudaMatrix &matrix(Index nrows, Index ncols);
+  const CudaPipeline &pipeline() const { return _pipeline; };
+
+ private:
+  const CudaPipeline &_pipeline;
+  std::unique_ptr<Workspace::Scope> _scope;
+  // Released before the scope, deque keeps the references valid
+  std::deque<CudaMatrix> _matrices;
+};
+
+template <typename Derived>
+struct CudaExpr {
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
+};
+
+class MatrixExpr : public CudaExpr<MatrixExpr> {
+ public:
+  MatrixExpr(const CudaMatrix &A, Operation op = Operation::None,
+             double alpha = 1.)
+      : _A{&A}, _op{op}, _alpha{alpha} {};
+
+  void collect(std::vector<Term> &terms, double scale, Temporaries &) const {
+    terms.push_back(Term{scale * _alpha, _A, _op, nullptr, Operation::None});
+  }
+
+  const CudaMatrix &matrix() const { return *_A; };
+  Operation op() const { return _op; };
+  double alpha() const { return _alpha; };
+
+ private:
+  const CudaMatrix *_A;
+  Operation _op;
+  double _alpha;
+};
+
+class ProductExpr : public CudaExpr<ProductExpr> {
+ public:
+  ProductExpr(const MatrixExpr &lhs, const MatrixExpr &rhs)
+      : _lhs{lhs}, _rhs{rhs} {};
+
+  void collect(std::vector<Term> &terms, double scale, Temporaries &) const {
+    double alpha = scale * _lhs.alpha() * _rhs.alpha();
+    terms.push_back(
+        Term{alpha, &_lhs.matrix(), _lhs.op(), &_rhs.matrix(), _rhs.op()});
+  }
+
+ private:
+  MatrixExpr _lhs;
+  MatrixExpr _rhs;
+};
+
+template <typename E>
+class ScaledExpr : public CudaExpr<ScaledExpr<E>> {
+ public:
+  ScaledExpr(const E &expr, double alpha) : _expr{expr}, _alpha{alpha} {};
+
+  void collect(std::vector<Term> &terms, double scale,
+               Temporaries &temporaries) const {
+    _expr.collect(terms, scale * _alpha, temporaries);
+  }
+
+ private:
+  E _expr;
+  double _alpha;
+};
+
+template <typename L, typename R>
+class SumExpr : public CudaExpr<SumExpr<L, R>> {
+ public:
+  SumExpr(const L &lhs, const R &rhs) : _lhs{lhs}, _rhs{rhs} {};
+
+  void collect(std::vector<Term> &terms, double scale,
+               Temporaries &temporaries) const {
+    _lhs.collect(terms, scale, temporaries);
+    _rhs.collect(terms, scale, temporaries);
+  }
+
+ private:
+  L _lhs;
+  R _rhs;
+};
+
+// Evaluate the flattened terms into D
+void evaluate(const CudaPipeline &pipeline, const std::vector<Term> &terms,
+              CudaMatrix &D);
+
+// Factor of a product, evaluated into a temporary unless it is a matrix
+inline MatrixExpr materialize(const MatrixExpr &expr, Temporaries &) {
+  return expr;
+}
+template <typename E>
+MatrixExpr materialize(const CudaExpr<E> &expr, Temporaries &temporaries) {
+  std::vector<Term> terms;
+  expr.derived().collect(terms, 1., temporaries);
+  CudaMatrix &result =
+      temporaries.matrix(terms.front().rows(), terms.front().cols());
+  evaluate(temporaries.pipeline(), terms, result);
+  return MatrixExpr{result};
+}
+
+// Product with an expression as a factor, e.g. (A * B) * C
+template <typename L, typename R>
+class NestedProductExpr : public CudaExpr<NestedProductExpr<L, R>> {
+ public:
+  NestedProductExpr(const L &lhs, const R &rhs) : _lhs{lhs}, _rhs{rhs} {};
+
+  void collect(std::vector<Term> &terms, double scale,
+               Temporaries &temporaries) const {
+    ProductExpr{materialize(_lhs, temporaries),
+                materialize(_rhs, temporaries)}
+        .collect(terms, scale, temporaries);
+  }
+
+ private:
+  L _lhs;
+  R _rhs;
+};
+
+inline MatrixExpr transpose(const CudaMatrix &A) {
+  return MatrixExpr{A, Operation::Transpose};
+}
+
+// Products of two (scaled or transposed) matrices
+inline ProductExpr operator*(const MatrixExpr &A, const MatrixExpr &B) {
+  return ProductExpr{A, B};
+}
+inline ProductExpr operator*(const CudaMatrix &A, const CudaMatrix &B) {
+  return ProductExpr{MatrixExpr{A}, MatrixExpr{B}};
+}
+inline ProductExpr operator*(const MatrixExpr &A, const CudaMatrix &B) {
+  return ProductExpr{A, MatrixExpr{B}};
+}
+inline ProductExpr operator*(const CudaMatrix &A, const MatrixExpr &B) {
+  return ProductExpr{MatrixExpr{A}, B};
+}
+// Products of products or of other expressions
+template <typename L, typename R>
+NestedProductExpr<L, R> operator*(const CudaExpr<L> &lhs,
+                                  const CudaExpr<R> &rhs) {
+  return NestedProductExpr<L, R>{lhs.derived(), rhs.derived()};
+}
+template <typename L>
+NestedProductExpr<L, MatrixExpr> operator*(const CudaExpr<L> &lhs,
+                                           const CudaMatrix &B) {
+  return NestedProductExpr<L, MatrixExpr>{lhs.derived(), MatrixExpr{B}};
+}
+template <typename R>
+NestedProductExpr<MatrixExpr, R> operator*(const CudaMatrix &A,
+                                           const CudaExpr<R> &rhs) {
+  return NestedProductExpr<MatrixExpr, R>{MatrixExpr{A}, rhs.derived()};
+}
+
+// Scalar multiples
+inline MatrixExpr operator*(double alpha, const CudaMatrix &A) {
+  return MatrixExpr{A, Operation::None, alpha};
+}
+inline MatrixExpr operator*(double alpha, const MatrixExpr &A) {
+  return MatrixExpr{A.matrix(), A.op(), alpha * A.alpha()};
+}
+inline MatrixExpr operator-(const CudaMatrix &A) {
+  return MatrixExpr{A, Operation::None, -1.};
+}
+inline MatrixExpr operator-(const MatrixExpr &A) {
+  return MatrixExpr{A.matrix(), A.op(), -A.alpha()};
+}
+template <typename E>
+ScaledExpr<E> operator*(double alpha, const CudaExpr<E> &expr) {
+  return ScaledExpr<E>{expr.derived(), alpha};
+}
+template <typename E>
+ScaledExpr<E> operator-(const CudaExpr<E> &expr) {
+  return ScaledExpr<E>{expr.derived(), -1.};
+}
+
+// Sums and differences
+inline SumExpr<MatrixExpr, MatrixExpr> operator+(const CudaMatrix &A,
+                                                 const CudaMatrix &B) {
+  return SumExpr<MatrixExpr, MatrixExpr>{MatrixExpr{A}, MatrixExpr{B}};
+}
+inline SumExpr<MatrixExpr, MatrixExpr> operator-(const CudaMatrix &A,
+                                                 const CudaMatrix &B) {
+  return SumExpr<MatrixExpr, MatrixExpr>{MatrixExpr{A},
+                                         MatrixExpr{B, Operation::None, -1.}};
+}
+template <typename L, typename R>
+SumExpr<L, R> operator+(const CudaExpr<L> &lhs, const CudaExpr<R> &rhs) {
+  return SumExpr<L, R>{lhs.derived(), rhs.derived()};
+}
+template <typename L>
+SumExpr<L, MatrixExpr> operator+(const CudaExpr<L> &lhs, const CudaMatrix &B) {
+  return SumExpr<L, MatrixExpr>{lhs.derived(), MatrixExpr{B}};
+}
+template <typename R>
+SumExpr<MatrixExpr, R> operator+(const CudaMatrix &A, const CudaExpr<R> &rhs) {
+  return SumExpr<MatrixExpr, R>{MatrixExpr{A}, rhs.derived()};
+}
+template <typename L, typename R>
+SumExpr<L, ScaledExpr<R>> operator-(const CudaExpr<L> &lhs,
+                                    const CudaExpr<R> &rhs) {
+  return SumExpr<L, ScaledExpr<R>>{lhs.derived(),
+                                   ScaledExpr<R>{rhs.derived(), -1.}};
+}
+template <typename L>
+SumExpr<L, MatrixExpr> operator-(const CudaExpr<L> &lhs, const CudaMatrix &B) {
+  return SumExpr<L, MatrixExpr>{lhs.derived(),
+                                MatrixExpr{B, Operation::None, -1.}};
+}
+template <typename R>
+SumExpr<MatrixExpr, ScaledExpr<R>> operator-(const CudaMatrix &A,
+                                             const CudaExpr<R> &rhs) {
+  return SumExpr<MatrixExpr, ScaledExpr<R>>{MatrixExpr{A},
+                                            ScaledExpr<R>{rhs.derived(), -1.}};
+}
+
+// D = expr, the expression is evaluated without temporaries unless D is
+// also one of the factors of a product or the products are nested
+template <typename E>
+void evaluate(const CudaPipeline &pipeline, const CudaExpr<E> &expr,
+              CudaMatrix &D) {
+  Temporaries temporaries{pipeline};
+  std::vector<Term> terms;
+  expr.derived().collect(terms, 1., temporaries);
+  evaluate(pipeline, terms, D);
+}
+inline void evaluate(const CudaPipeline &pipeline, const CudaMatrix &A,
+                     CudaMatrix &D) {
+  evaluate(pipeline, MatrixExpr{A}, D);
+}
+
+}  // namespace eigencuda
+
+#endif  // CUDA_EXPRESSION_H_
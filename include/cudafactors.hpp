@@ -0,0 +1,88 @@
+#ifndef CUDA_FACTORS_H_
+#define CUDA_FACTORS_H_
+
+#include "cudamatrix.hpp"
+#include "cudatensor.hpp"
+
+/*
+ * \brief Factorizations kept in the device
+ *
+ * The factors are computed once by the `CudaPipeline` (potrf/getrf) and
+ * reused by every solve (potrs/getrs) against the same matrix. The batched
+ * factors hold those of a whole tensor of independent matrices.
+ */
+
+namespace eigencuda {
+
+// Lower triangular L with A = L * L^T
+class CholeskyFactor {
+ public:
+  const CudaMatrix &matrix() const { return _factor; };
+  Index rows() const { return _factor.rows(); };
+
+ private:
+  friend class CudaPipeline;
+  explicit CholeskyFactor(CudaMatrix &&factor) : _factor{std::move(factor)} {};
+
+  CudaMatrix _factor;
+};
+
+// P * A = L * U, with L and U packed in a single matrix
+class LUFactor {
+ public:
+  const CudaMatrix &matrix() const { return _factor; };
+  Index rows() const { return _factor.rows(); };
+  // Row interchanges, following the LAPACK 1-based convention
+  const int *pivots() const { return _pivots.get(); };
+
+ private:
+  friend class CudaPipeline;
+  // Unique pointer with custom delete function
+  using Unique_ptr_to_GPU_pivots = std::unique_ptr<int, void (*)(int *)>;
+
+  explicit LUFactor(CudaMatrix &&factor);
+
+  CudaMatrix _factor;
+  Unique_ptr_to_GPU_pivots _pivots{nullptr,
+                                   [](int *x) { checkCuda(cudaFree(x)); }};
+};
+
+// L_i with A_i = L_i * L_i^T for every matrix of a batch, in the lower
+// triangles of the tensor
+class BatchedCholeskyFactor {
+ public:
+  const CudaTensor &tensor() const { return _factors; };
+  Index rows() const { return _factors.rows(); };
+  Index depth() const { return _factors.depth(); };
+
+ private:
+  friend class CudaPipeline;
+  explicit BatchedCholeskyFactor(CudaTensor &&factors)
+      : _factors{std::move(factors)} {};
+
+  CudaTensor _factors;
+};
+
+// P_i * A_i = L_i * U_i for every matrix of a batch
+class BatchedLUFactor {
+ public:
+  const CudaTensor &tensor() const { return _factors; };
+  Index rows() const { return _factors.rows(); };
+  Index depth() const { return _factors.depth(); };
+  // Row interchanges of matrix i start at pivots() + i * rows()
+  const int *pivots() const { return _pivots.get(); };
+
+ private:
+  friend class CudaPipeline;
+  using Unique_ptr_to_GPU_pivots = std::unique_ptr<int, void (*)(int *)>;
+
+  explicit BatchedLUFactor(CudaTensor &&factors);
+
+  CudaTensor _factors;
+  Unique_ptr_to_GPU_pivots _pivots{nullptr,
+                                   [](int *x) { checkCuda(cudaFree(x)); }};
+};
+
+}  // namespace eigencuda
+
+#endif  // CUDA_FACTORS_H_
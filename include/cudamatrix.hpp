@@ -8,6 +8,8 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 /*
@@ -24,24 +26,102 @@ cudaError_t checkCuda(cudaError_t result);
 using Index = Eigen::Index;
 Index count_available_gpus();
 
+// Device memory is only visible to the GPU, while managed (unified) memory
+// migrates on demand between the host and the device
+enum class MemoryKind { Device, Managed };
+
+// A row major matrix is stored as its transpose in column major order, the
+// pipeline maps it to transposed BLAS operations instead of moving data
+enum class StorageOrder { ColMajor, RowMajor };
+
+using RowMajorMatrixXd =
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
 class CudaMatrix {
  public:
   Index size() const { return _rows * _cols; };
   Index rows() const { return _rows; };
   Index cols() const { return _cols; };
+  // Number of elements that fit in the allocated memory
+  Index capacity() const { return _capacity; };
   double *data() const { return _data.get(); };
+  const cudaStream_t &stream() const { return _stream; };
+  StorageOrder storage_order() const { return _order; };
+  // Distance between consecutive columns (rows if row major)
+  Index leading_dimension() const {
+    return (_order == StorageOrder::ColMajor) ? _rows : _cols;
+  };
 
   CudaMatrix(const Eigen::MatrixXd &matrix, const cudaStream_t &stream);
+  CudaMatrix(const RowMajorMatrixXd &matrix, const cudaStream_t &stream);
+  // Any other Eigen expression is evaluated keeping its storage order
+  template <typename Derived>
+  CudaMatrix(const Eigen::MatrixBase<Derived> &matrix,
+             const cudaStream_t &stream)
+      : CudaMatrix{typename std::conditional<Derived::IsRowMajor,
+                                             RowMajorMatrixXd,
+                                             Eigen::MatrixXd>::type(matrix),
+                   stream} {};
 
   // Allocate memory in the GPU for a matrix
-  CudaMatrix(Index nrows, Index ncols, const cudaStream_t &stream);
+  CudaMatrix(Index nrows, Index ncols, const cudaStream_t &stream,
+             MemoryKind kind = MemoryKind::Device,
+             StorageOrder order = StorageOrder::ColMajor);
+
+  CudaMatrix(const CudaMatrix &) = delete;
+  CudaMatrix &operator=(const CudaMatrix &) = delete;
 
-  // Convert A Cudamatrix to an EigenMatrix
+  // The moved-from matrix is left empty
+  CudaMatrix(CudaMatrix &&other) noexcept;
+  CudaMatrix &operator=(CudaMatrix &&other) noexcept;
+
+  // Convert A Cudamatrix to an EigenMatrix, in any storage order
   operator Eigen::MatrixXd() const;
+  operator RowMajorMatrixXd() const;
 
+  // Resize the matrix to the shape and storage order of A before copying it
   void copy_to_gpu(const Eigen::MatrixXd &A);
+  void copy_to_gpu(const RowMajorMatrixXd &A);
+
+  // Change the shape reusing the allocated memory when the capacity
+  // suffices. Like Eigen's resize, the content is not preserved. A view
+  // cannot grow beyond its capacity
+  void resize(Index nrows, Index ncols);
+  void resize(Index nrows, Index ncols, StorageOrder order);
+
+  // Change the shape keeping the content, the size must not change
+  void reshape(Index nrows, Index ncols);
+
+  // Release the memory beyond size(), keeping the content. Views do not own
+  // their memory and throw
+  void shrink_to_fit();
+
+  // Non-owning view of `count` consecutive columns of a column major matrix,
+  // valid while the matrix lives. Its shape must not change when used as
+  // the output of an operation
+  CudaMatrix middle_cols(Index first, Index count) const;
+
+  // False for the views of memory owned by somebody else: slices, column
+  // ranges and workspace matrices
+  bool owns_memory() const { return _owns_memory; };
+
+  MemoryKind memory_kind() const { return _kind; };
+
+  // Host access to a managed column major matrix. The pipeline stream must be
+  // synchronized before touching the data from the host
+  Eigen::Map<Eigen::MatrixXd> host_view() const;
 
  private:
+  friend class CudaTensor;
+  friend class Workspace;
+
+  // View of memory owned by somebody else, e.g. a Workspace
+  CudaMatrix(double *data, Index nrows, Index ncols,
+             const cudaStream_t &stream,
+             MemoryKind kind = MemoryKind::Device);
+
+  void throw_if_view(const std::string &operation) const;
+
   // Unique pointer with custom delete function
   using Unique_ptr_to_GPU_data = std::unique_ptr<double, void (*)(double *)>;
 
@@ -55,8 +135,12 @@ class CudaMatrix {
   Unique_ptr_to_GPU_data _data{nullptr,
                                [](double *x) { checkCuda(cudaFree(x)); }};
   cudaStream_t _stream = nullptr;
+  MemoryKind _kind = MemoryKind::Device;
+  StorageOrder _order = StorageOrder::ColMajor;
   Index _rows;
   Index _cols;
+  Index _capacity;
+  bool _owns_memory = true;
 };
 
 }  // namespace eigencuda
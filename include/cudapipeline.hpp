@@ -1,7 +1,19 @@
 #ifndef CUDA_PIPELINE__H
 #define CUDA_PIPELINE__H
 
+#include "contraction.hpp"
+#include "cudafactors.hpp"
 #include "cudamatrix.hpp"
+#include "cudasparse.hpp"
+#include "cudatensor.hpp"
+#include "cudavector.hpp"
+#include "davidson.hpp"
+#include "matrixchain.hpp"
+#include <cstdint>
+#include <cusolverDn.h>
+#include "operations.hpp"
+#include "stagingring.hpp"
+#include "workspace.hpp"
 
 /*
  * \brief Perform Tensor-matrix multiplications in a GPU
@@ -16,29 +28,326 @@ namespace eigencuda {
  * using the CUDA language. The Cublas handle is the context manager for all the
  * resources needed by Cublas. While a stream is a queue of sequential
  * operations executed in the Nvidia device.
+ *
+ * Row major matrices are handled by transposing the BLAS operations, so they
+ * are never transposed in memory. The eigensolvers and factorizations accept
+ * them as input, while the right hand sides of the solves and column_norms
+ * require column major storage.
  */
 class CudaPipeline {
  public:
   CudaPipeline() {
     cublasCreate(&_handle);
+    cusolverDnCreate(&_solver_handle);
+    cusparseCreate(&_sparse_handle);
     cudaStreamCreate(&_stream);
+    // Run the library calls in the same queue as the memory operations
+    cublasSetStream(_handle, _stream);
+    cusolverDnSetStream(_solver_handle, _stream);
+    cusparseSetStream(_sparse_handle, _stream);
+    cudaGetDevice(&_device);
   }
   ~CudaPipeline();
 
   CudaPipeline(const CudaPipeline &) = delete;
   CudaPipeline &operator=(const CudaPipeline &) = delete;
 
-  // Invoke the ?gemm function of cublas
+  // Invoke the ?gemm function of cublas, C is resized to the product shape
   void gemm(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C) const;
 
+  // C = alpha * op(A) * op(B) + beta * C
+  void gemm(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+            double alpha, double beta, Operation op_A = Operation::None,
+            Operation op_B = Operation::None) const;
+
+  // C = alpha * op(A) + beta * op(B), C may alias A or B when not transposed
+  void geam(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+            double alpha, double beta, Operation op_A = Operation::None,
+            Operation op_B = Operation::None) const;
+
+  // R_i = T_i * B for every matrix of the tensor T, in a single batched call
+  void gemm(const CudaTensor &T, const CudaMatrix &B, CudaTensor &R) const;
+
+  // C_i = A_i * B_i for every pair of matrices of the tensors. Square matrices
+  // up to 32 x 32 use kernels specialized for their size, which avoid the
+  // launch overhead of cublas on tiny products
+  void gemm_batched(const CudaTensor &A, const CudaTensor &B,
+                    CudaTensor &C) const;
+
+  // C = A * B computed from lower precision products (Ozaki scheme): the
+  // rows of A and columns of B are split into slices whose products are
+  // exact in single precision, and the products are summed in double. The
+  // error is about 2^-bits times the largest entries of the row of A and
+  // the column of B, fewer bits take fewer slices and products. A and B must
+  // be column major. The result does not depend on the order of the single
+  // precision sums, CpuPipeline::gemm_split reproduces it bitwise
+  void gemm_split(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+                  int bits = 53,
+                  SplitArithmetic arithmetic = SplitArithmetic::Single) const;
+
+  // y = alpha * op(A) * x + beta * y, y is resized when beta is zero
+  void gemv(const CudaMatrix &A, const CudaVector &x, CudaVector &y,
+            double alpha = 1., double beta = 0.,
+            Operation op = Operation::None) const;
+  // Apply op(A) to every column of X in a single gemm call, so a block of
+  // vectors streams through the operator once
+  void gemv_batched(const CudaMatrix &A, const CudaMatrix &X, CudaMatrix &Y,
+                    Operation op = Operation::None) const;
+
+  // Sparse times dense products, the cost scales with the nonzeros of A.
+  // C = alpha * op(A) * B + beta * C, C is resized when beta is zero
+  void spmm(const CudaSparseMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+            double alpha = 1., double beta = 0.,
+            Operation op = Operation::None) const;
+  // y = alpha * op(A) * x + beta * y
+  void spmv(const CudaSparseMatrix &A, const CudaVector &x, CudaVector &y,
+            double alpha = 1., double beta = 0.,
+            Operation op = Operation::None) const;
+
+  // Device to device copy of A into B
+  void copy(const CudaMatrix &A, CudaMatrix &B) const;
+
+  // Element-wise operations executed in the pipeline stream
+  // A = alpha * A
+  void scale(CudaMatrix &A, double alpha) const;
+  // Y = alpha * X + Y
+  void axpy(double alpha, const CudaMatrix &X, CudaMatrix &Y) const;
+  // C = A + B
+  void add(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C) const;
+  // C = A .* B
+  void hadamard_product(const CudaMatrix &A, const CudaMatrix &B,
+                        CudaMatrix &C) const;
+  // C = A ./ B
+  void hadamard_division(const CudaMatrix &A, const CudaMatrix &B,
+                         CudaMatrix &C) const;
+  // A = f(A)
+  void apply(CudaMatrix &A, UnaryFunction function) const;
+
+  // Fill A in the device with a counter based generator (Philox4x32-10): the
+  // i-th element of the buffer is number i of the sequence (seed,
+  // subsequence). CpuPipeline::random generates the same numbers on the host
+  void random(CudaMatrix &A, Distribution distribution, std::uint64_t seed,
+              std::uint64_t subsequence = 0) const;
+
+  // Reductions computed in the device, only the result is transferred
+  double norm(const CudaMatrix &A, Norm type = Norm::Frobenius) const;
+  double sum(const CudaMatrix &A) const;
+  double trace(const CudaMatrix &A) const;
+  // sum(A .* B)
+  double dot(const CudaMatrix &A, const CudaMatrix &B) const;
+  Eigen::VectorXd column_norms(const CudaMatrix &A) const;
+
+  // Eigenvalues (ascending) and eigenvectors (columns) of the symmetric
+  // matrix A, using its lower triangle
+  void syevd(const CudaMatrix &A, CudaMatrix &eigenvalues,
+             CudaMatrix &eigenvectors) const;
+  // Only the `count` eigenpairs starting from the `first` lowest one
+  void syevdx(const CudaMatrix &A, Index first, Index count,
+              CudaMatrix &eigenvalues, CudaMatrix &eigenvectors) const;
+
+  // Lowest `count` eigenpairs of the symmetric matrix A by block Davidson
+  // with a diagonal preconditioner. The subspace, its image and the
+  // projected matrix stay in the device (in the workspace when reserved),
+  // each iteration downloads the norms of the residuals and, in a single
+  // transfer, those of the new directions. The eigenvalues are ascending,
+  // the eigenvectors are the columns of `eigenvectors`
+  DavidsonResult davidson(const CudaMatrix &A, Index count,
+                          CudaMatrix &eigenvalues, CudaMatrix &eigenvectors,
+                          const DavidsonOptions &options = {}) const;
+  // Matrix free version, `apply` multiplies A by a block of vectors and
+  // `diagonal` (n x 1) holds the diagonal of A for the preconditioner
+  DavidsonResult davidson(const LinearOperator &apply,
+                          const CudaMatrix &diagonal, Index count,
+                          CudaMatrix &eigenvalues, CudaMatrix &eigenvectors,
+                          const DavidsonOptions &options = {}) const;
+
+  // Truncated SVD A ~ U * diag(S) * V^T of the given rank, found by the
+  // randomized range finder of Halko, Martinsson and Tropp. The range is
+  // sketched with rank + oversampling random vectors and sharpened by power
+  // iterations. All the temporaries stay in the device, taken from the
+  // workspace when one is reserved
+  void randomized_svd(const CudaMatrix &A, Index rank, CudaMatrix &U,
+                      CudaMatrix &S, CudaMatrix &V, Index oversampling = 10,
+                      Index power_iterations = 2,
+                      std::uint64_t seed = 0) const;
+
+  // Symmetric products computing only `triangle` of C, Triangle::Full
+  // mirrors the lower triangle into the upper one.
+  // C = op(A) * op(A)^T, the Gram matrix A^T * A by default
+  void syrk(const CudaMatrix &A, CudaMatrix &C,
+            Triangle triangle = Triangle::Full,
+            Operation op = Operation::Transpose) const;
+  // C = op(A) * op(B)^T + op(B) * op(A)^T
+  void syr2k(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+             Triangle triangle = Triangle::Full,
+             Operation op = Operation::Transpose) const;
+  // C = A * B (left) or C = B * A (right) using the lower triangle of the
+  // symmetric matrix A
+  void symm(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+            Side side = Side::Left) const;
+
+  // Triangular operations using only `triangle` of the square matrix A, e.g.
+  // the factor of potrf. Every column (row for Side::Right) of B is a
+  // right-hand side, so a whole block of them is handled in a single call.
+  // B = alpha * op(A)^-1 * B (left) or B = alpha * B * op(A)^-1 (right)
+  void trsm(const CudaMatrix &A, CudaMatrix &B, Side side = Side::Left,
+            Triangle triangle = Triangle::Lower,
+            Operation op = Operation::None,
+            Diagonal diagonal = Diagonal::NonUnit, double alpha = 1.) const;
+  // C = alpha * op(A) * B (left) or C = alpha * B * op(A) (right), C may be B
+  void trmm(const CudaMatrix &A, const CudaMatrix &B, CudaMatrix &C,
+            Side side = Side::Left, Triangle triangle = Triangle::Lower,
+            Operation op = Operation::None,
+            Diagonal diagonal = Diagonal::NonUnit, double alpha = 1.) const;
+  // Download the symmetric matrix C transferring only the stored triangle
+  Eigen::MatrixXd copy_symmetric_to_host(
+      const CudaMatrix &C, Triangle triangle = Triangle::Lower) const;
+
+  // Cholesky factorization of the symmetric positive definite matrix A,
+  // using its lower triangle
+  CholeskyFactor potrf(const CudaMatrix &A) const;
+  // Overwrite B with the solution X of A * X = B
+  void potrs(const CholeskyFactor &factor, CudaMatrix &B) const;
+
+  // LU factorization with partial pivoting of the square matrix A
+  LUFactor getrf(const CudaMatrix &A) const;
+  // Overwrite B with the solution X of A * X = B
+  void getrs(const LUFactor &factor, CudaMatrix &B) const;
+
+  // Batched factorizations of the independent square matrices of a tensor,
+  // each call handling the whole batch. A failure names the first matrix
+  // that is singular or not positive definite.
+  // Cholesky factors of every A_i, using their lower triangles
+  BatchedCholeskyFactor potrf_batched(const CudaTensor &A) const;
+  // Overwrite B_i with the solution X_i of A_i * X_i = B_i
+  void potrs_batched(const BatchedCholeskyFactor &factor, CudaTensor &B) const;
+  BatchedLUFactor getrf_batched(const CudaTensor &A) const;
+  void getrs_batched(const BatchedLUFactor &factor, CudaTensor &B) const;
+  // inverse_i = A_i^-1, in a single call of cublas matinvBatched up to
+  // 32 x 32 and through the LU factors for larger matrices
+  void inverse_batched(const CudaTensor &A, CudaTensor &inverse) const;
+
+  // Tensor contractions, e.g. einsum("Pij,jk->Pik", {{T, {P, I, J}}, B}, R).
+  // The result is a column major matrix whose rows are its first index
+  void einsum(const std::string &expression,
+              const std::vector<CudaOperand> &operands,
+              CudaMatrix &result) const;
+  // Execute a plan computed once for the shapes of the operands. The
+  // intermediates come from the workspace when one is reserved
+  void contract(const ContractionPlan &plan,
+                const std::vector<CudaOperand> &operands,
+                CudaMatrix &result) const;
+
+  // Matrix chain products, e.g. chain_product({A, B, C, D}, R), in the order
+  // with the fewest operations. The intermediates recycle their buffers and
+  // come from the workspace when one is reserved
+  void chain_product(const ChainOperands<CudaMatrix> &operands,
+                     CudaMatrix &result) const;
+  // Execute a plan computed once for the shapes of the operands. The
+  // intermediates come from the workspace when one is reserved
+  void chain_product(const ChainPlan &plan,
+                     const ChainOperands<CudaMatrix> &operands,
+                     CudaMatrix &result) const;
+
   const cudaStream_t &get_stream() const { return _stream; };
 
+  // Bitwise reproducible results for identical inputs on the same device:
+  // cublas runs without atomics nor reduced precision math, cusparse and
+  // cusolver use their deterministic algorithms, and the transposed sparse
+  // products multiply by the explicit transpose. The kernels of the library
+  // (reductions, batched products, random fills) always accumulate in a
+  // fixed order. Device and host results still differ by rounding
+  void set_deterministic(bool deterministic);
+  bool deterministic() const { return _deterministic; };
+
+  // Wait for the asynchronous transfers and operations of the stream
+  void synchronize() const;
+
+  // Reserve a block of `bytes` in the device for the temporaries
+  void reserve_workspace(size_t bytes);
+  Workspace &workspace() const;
+
+  // Pinned buffers used to stream pageable host memory, allocated on first use
+  StagingRing &staging();
+
+  // Transfers that pipeline pageable host memory through the staging ring.
+  // Pinned memory and small matrices are copied directly. B takes the storage
+  // order of A on upload, downloads into the other order convert on the host
+  void copy_to_gpu(const Eigen::MatrixXd &A, CudaMatrix &B);
+  void copy_to_gpu(const RowMajorMatrixXd &A, CudaMatrix &B);
+  void copy_to_host(const CudaMatrix &A, Eigen::MatrixXd &B);
+  void copy_to_host(const CudaMatrix &A, RowMajorMatrixXd &B);
+
+  // Migrate a managed matrix in bulk ahead of its use
+  void prefetch_to_device(const CudaMatrix &A) const;
+  void prefetch_to_host(const CudaMatrix &A) const;
+
+  // Keep read-only copies of a managed matrix on both sides
+  void advise_read_mostly(const CudaMatrix &A, bool read_mostly = true) const;
+
  private:
+  // Takes the nested products of the expressions from the workspace
+  friend class Temporaries;
+
   // The cublas handles allocates hardware resources on the host and device.
   cublasHandle_t _handle;
 
+  // Same for the dense cusolver routines
+  cusolverDnHandle_t _solver_handle;
+
+  // Same for the sparse routines
+  cusparseHandle_t _sparse_handle;
+
   // Asynchronous stream
   cudaStream_t _stream;
+
+  // Device where the stream lives
+  int _device = 0;
+
+  bool _deterministic = false;
+
+  // Arena for the temporaries of the operations running on the stream
+  std::unique_ptr<Workspace> _workspace;
+
+  std::unique_ptr<StagingRing> _staging;
+
+  // Raw transfers of the whole buffer of a matrix
+  void upload(const double *host, CudaMatrix &B);
+  void download(const CudaMatrix &A, double *host);
+
+  // Scratch memory of the reductions, allocated on first use
+  double *reduction_buffer() const;
+  mutable std::unique_ptr<CudaMatrix> _reduction_buffer;
+
+  // Scratch memory of the sparse products, grown on demand
+  void *sparse_buffer(size_t bytes) const;
+  mutable std::unique_ptr<CudaMatrix> _sparse_buffer;
+
+  // Temporary matrix taken from the workspace when one is reserved, released
+  // with the scope returned by workspace_scope (null without a workspace)
+  CudaMatrix scratch(Index nrows, Index ncols) const;
+  std::unique_ptr<Workspace::Scope> workspace_scope() const;
+
+  // Overwrite the columns of Y with an orthonormal basis of their span
+  void orthonormalize(CudaMatrix &Y) const;
+  // Orthonormalize the `candidates` columns of V from m against its first m
+  // columns and among themselves, moving the independent ones first and
+  // returning how many they are. Used by the Davidson solver
+  Index orthogonalize_block(CudaMatrix &V, Index m, Index candidates) const;
+
+  // Copy a scalar computed in the device to the host
+  double download_scalar(const double *device_scalar) const;
+
+  // Raise an error if a cusolver routine reported a failure in `info`
+  void throw_if_solver_failed(const CudaMatrix &info,
+                              const std::string &routine) const;
+  // Same for the `batch` statuses of a batched routine
+  void throw_if_batch_failed(const CudaMatrix &info, Index batch,
+                             const std::string &routine) const;
+
+  // Device array of pointers to the matrices of T, the operand of the
+  // batched routines, taken from the workspace when one is reserved
+  CudaMatrix matrix_pointers(const CudaTensor &T) const;
 };
 
 }  // namespace eigencuda
@@ -0,0 +1,76 @@
+#ifndef CUDA_SPARSE_H_
+#define CUDA_SPARSE_H_
+
+#include "cudamatrix.hpp"
+#include <Eigen/Sparse>
+#include <cusparse.h>
+#include <type_traits>
+
+/*
+ * \brief Sparse matrix stored in the device
+ *
+ * The matrix is kept in compressed sparse row (CSR) format, so the memory and
+ * the cost of the products performed by the `CudaPipeline` (spmm/spmv) are
+ * proportional to the number of nonzeros.
+ */
+
+namespace eigencuda {
+
+class CudaSparseMatrix {
+ public:
+  // Converts the (column major) Eigen matrix to CSR and uploads it
+  CudaSparseMatrix(const Eigen::SparseMatrix<double> &matrix,
+                   const cudaStream_t &stream);
+
+  CudaSparseMatrix(const CudaSparseMatrix &) = delete;
+  CudaSparseMatrix &operator=(const CudaSparseMatrix &) = delete;
+  CudaSparseMatrix(CudaSparseMatrix &&) = default;
+  CudaSparseMatrix &operator=(CudaSparseMatrix &&) = default;
+
+  Index rows() const { return _rows; };
+  Index cols() const { return _cols; };
+  Index nonzeros() const { return _values.size(); };
+
+  // Convert a CudaSparseMatrix to an Eigen sparse matrix
+  operator Eigen::SparseMatrix<double>() const;
+
+  // Descriptor used by the generic cusparse API
+  cusparseSpMatDescr_t descriptor() const { return _descriptor.get(); };
+
+  // Explicit transpose in CSR, converted in the device the first time it is
+  // requested and kept with the matrix. cusparse has no deterministic
+  // algorithm for the transposed products, the deterministic mode of the
+  // `CudaPipeline` multiplies by this matrix instead
+  const CudaSparseMatrix &transpose(cusparseHandle_t handle) const;
+
+ private:
+  // Uninitialized matrix with room for `nonzeros` entries
+  CudaSparseMatrix(Index rows, Index cols, Index nonzeros,
+                   const cudaStream_t &stream);
+
+  void create_descriptor();
+
+  // Unique pointers with custom delete functions
+  using Unique_ptr_to_GPU_indices = std::unique_ptr<int, void (*)(int *)>;
+  using Unique_ptr_to_descriptor =
+      std::unique_ptr<std::remove_pointer<cusparseSpMatDescr_t>::type,
+                      void (*)(cusparseSpMatDescr_t)>;
+
+  Unique_ptr_to_GPU_indices alloc_indices_in_gpu(Index size) const;
+
+  Index _rows;
+  Index _cols;
+  cudaStream_t _stream = nullptr;
+
+  // CSR arrays: row offsets (rows + 1), column indices and values
+  Unique_ptr_to_GPU_indices _row_offsets{nullptr, [](int *) {}};
+  Unique_ptr_to_GPU_indices _column_indices{nullptr, [](int *) {}};
+  CudaMatrix _values;
+  Unique_ptr_to_descriptor _descriptor{
+      nullptr, [](cusparseSpMatDescr_t x) { cusparseDestroySpMat(x); }};
+  mutable std::unique_ptr<CudaSparseMatrix> _transpose;
+};
+
+}  // namespace eigencuda
+
+#endif  // CUDA_SPARSE_H_
@@ -0,0 +1,65 @@
+#ifndef CUDA_TENSOR_H_
+#define CUDA_TENSOR_H_
+
+#include "contraction.hpp"
+#include "cudamatrix.hpp"
+
+/*
+ * \brief Rank 3 tensor stored in a single device allocation
+ *
+ * The tensor is a stack of `depth` matrices of rows x cols, stored one after
+ * the other in column major order. The whole tensor moves between the host
+ * and the device in a single transfer, while every matrix can be used by the
+ * `CudaPipeline` through a slice view.
+ */
+
+namespace eigencuda {
+
+class CudaTensor {
+ public:
+  CudaTensor(Index rows, Index cols, Index depth, const cudaStream_t &stream);
+
+  // Upload matrices sharing the same shape
+  CudaTensor(const std::vector<Eigen::MatrixXd> &matrices,
+             const cudaStream_t &stream);
+
+  Index rows() const { return _rows; };
+  Index cols() const { return _cols; };
+  Index depth() const { return _depth; };
+  Index size() const { return _matrix.size(); };
+  double *data() const { return _matrix.data(); };
+  Shape shape() const { return Shape{_rows, _cols, _depth}; };
+
+  // Change the shape reusing the allocated memory when possible, the content
+  // is not preserved
+  void resize(Index rows, Index cols, Index depth);
+
+  // Non-owning view of the i-th matrix, valid while the tensor lives. Its
+  // shape must not change when used as the output of an operation
+  CudaMatrix slice(Index i) const;
+
+  // The matrices side by side, as a rows x (cols * depth) matrix
+  const CudaMatrix &matrix() const { return _matrix; };
+
+  // Operand of the tensor contractions
+  operator CudaOperand() const { return CudaOperand{_matrix, shape()}; };
+
+  // Bulk transfers, resizing the tensor to the shape of the source.
+  // `host` holds depth matrices of rows x cols one after the other
+  void copy_to_gpu(const std::vector<Eigen::MatrixXd> &matrices);
+  void copy_to_gpu(const double *host, Index rows, Index cols, Index depth);
+
+  // Bulk downloads, waiting for the transfer to finish
+  operator std::vector<Eigen::MatrixXd>() const;
+  void copy_to_host(double *host) const;
+
+ private:
+  Index _rows;
+  Index _cols;
+  Index _depth;
+  CudaMatrix _matrix;
+};
+
+}  // namespace eigencuda
+
+#endif  // CUDA_TENSOR_H_
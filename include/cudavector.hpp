@@ -0,0 +1,36 @@
+#ifndef CUDA_VECTOR_H_
+#define CUDA_VECTOR_H_
+
+#include "cudamatrix.hpp"
+
+/*
+ * \brief Vector stored in the device
+ *
+ * A `CudaVector` is a `CudaMatrix` with a single column, so it can be used
+ * by every operation of the pipeline. Its transfers are asynchronous: they
+ * only overlap with the host when the Eigen vector lives in pinned memory,
+ * and the stream must be synchronized before reading a downloaded vector.
+ */
+
+namespace eigencuda {
+
+class CudaVector : public CudaMatrix {
+ public:
+  CudaVector(const Eigen::VectorXd &vector, const cudaStream_t &stream);
+
+  // Allocate memory in the GPU for a vector
+  CudaVector(Index size, const cudaStream_t &stream);
+
+  // Convert a CudaVector to an Eigen vector, waiting for the stream
+  operator Eigen::VectorXd() const;
+
+  // Enqueue the upload of v, resizing the vector if needed
+  void copy_to_gpu(const Eigen::VectorXd &v);
+
+  // Enqueue the download into v, which is resized if needed
+  void copy_to_host(Eigen::VectorXd &v) const;
+};
+
+}  // namespace eigencuda
+
+#endif  // CUDA_VECTOR_H_
@@ -0,0 +1,44 @@
+#ifndef DAVIDSON_H_
+#define DAVIDSON_H_
+
+#include "cudamatrix.hpp"
+#include <functional>
+
+/*
+ * \brief Options and report of the Davidson eigensolver of `CudaPipeline`
+ *
+ * The block Davidson method finds the lowest eigenpairs of a large symmetric
+ * matrix from its products with blocks of vectors. Every iteration expands a
+ * subspace with the preconditioned residuals of the unconverged Ritz pairs,
+ * and restarts it on the current Ritz vectors when it grows too large.
+ */
+
+namespace eigencuda {
+
+// Y = A * X for a block of vectors X. Y has the shape of X and is a view,
+// so it must not be resized
+using LinearOperator =
+    std::function<void(const CudaMatrix &X, CudaMatrix &Y)>;
+
+struct DavidsonOptions {
+  // Vectors added to the subspace per iteration, the number of eigenpairs
+  // when zero
+  Index block_size = 0;
+  // Dimension of the subspace that triggers a restart, eight blocks when
+  // zero. It must hold the eigenpairs plus a block
+  Index max_subspace = 0;
+  Index max_iterations = 100;
+  // Convergence threshold of the residual norms |A x - theta x|
+  double tolerance = 1e-8;
+};
+
+struct DavidsonResult {
+  Index iterations = 0;
+  bool converged = false;
+  // Residual norms of the returned eigenpairs
+  Eigen::VectorXd residual_norms;
+};
+
+}  // namespace eigencuda
+
+#endif  // DAVIDSON_H_
@@ -0,0 +1,112 @@
+#ifndef MATRIX_CHAIN_H_
+#define MATRIX_CHAIN_H_
+
+#include "operations.hpp"
+#include <Eigen/Core>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * \brief Plans of matrix chain products A_0 * A_1 * ... * A_n-1
+ *
+ * The order of the products is found by dynamic programming over the shapes
+ * of the operands: the plan minimizes the floating point operations, breaking
+ * ties with the peak memory of the intermediate results. The plan is executed
+ * by a `CudaPipeline` or a `CpuPipeline`, recycling the buffers of the
+ * intermediates that are no longer needed.
+ */
+
+namespace eigencuda {
+
+using Index = Eigen::Index;
+
+// Operands of a chain, the matrices must outlive the call
+template <typename Matrix>
+using ChainOperands = std::vector<std::reference_wrapper<const Matrix>>;
+
+// Slots [0, number of operands) hold the operands, followed by the recycled
+// temporaries and the result
+struct ChainStep {
+  int left;
+  int right;
+  int output;
+  // output (m x n) = left (m x k) * right (k x n)
+  Index m;
+  Index n;
+  Index k;
+};
+
+class ChainPlan {
+ public:
+  // Plan the product of matrices of dims[i] x dims[i + 1]
+  explicit ChainPlan(const std::vector<Index> &dims);
+
+  const std::vector<Index> &dims() const { return _dims; };
+  Index length() const { return Index(_dims.size()) - 1; };
+  const std::vector<ChainStep> &steps() const { return _steps; };
+
+  // Number of elements of every slot and the slot holding the result
+  const std::vector<Index> &slot_sizes() const { return _slot_sizes; };
+  int result_slot() const { return int(_slot_sizes.size()) - 1; };
+
+  double flops() const { return _flops; };
+  // Largest number of elements of the temporaries alive at the same time,
+  // the result included
+  Index peak_memory() const { return _peak_memory; };
+
+  // The chosen order, e.g. "((0 1) 2)"
+  const std::string &parenthesization() const { return _parenthesization; };
+
+  // Raise an error unless the dimensions are the planned ones
+  void throw_if_incompatible(const std::vector<Index> &dims) const;
+
+  // Dimensions of a chain of matrices, checking that their shapes agree
+  template <typename Matrix>
+  static std::vector<Index> dims_of(const ChainOperands<Matrix> &operands) {
+    if (operands.empty()) {
+      throw std::runtime_error("Empty matrix chain");
+    }
+    std::vector<Index> dims{operands.front().get().rows()};
+    for (const Matrix &operand : operands) {
+      if (operand.rows() != dims.back()) {
+        throw std::runtime_error("Shape mismatch in the matrix chain");
+      }
+      dims.push_back(operand.cols());
+    }
+    return dims;
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const ChainPlan &plan);
+
+ private:
+  // Cost of the best product of the operands [i, j]
+  struct Cost {
+    double flops;
+    Index peak;
+    int split;
+  };
+
+  // Emit the steps of [i, j], returning the slot of its result. The last
+  // product writes into the result slot
+  int emit(int i, int j, const std::vector<std::vector<Cost>> &costs,
+           bool last);
+  std::string order(int i, int j,
+                    const std::vector<std::vector<Cost>> &costs) const;
+  // Temporary slot of at least `size` elements, reusing free ones first
+  int acquire(Index size);
+  void release(int slot);
+
+  std::vector<Index> _dims;
+  std::vector<ChainStep> _steps;
+  std::vector<Index> _slot_sizes;
+  std::vector<bool> _free;
+  double _flops = 0;
+  Index _peak_memory = 0;
+  std::string _parenthesization;
+};
+
+}  // namespace eigencuda
+
+#endif  // MATRIX_CHAIN_H_
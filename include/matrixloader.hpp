@@ -0,0 +1,21 @@
+#ifndef MATRIX_LOADER_H_
+#define MATRIX_LOADER_H_
+
+#include "cudapipeline.hpp"
+
+/*
+ * \brief Load raw column-major binaries of doubles straight into the device
+ *
+ * The file is memory mapped and streamed in chunks through the pinned
+ * staging ring of the pipeline, overlapping the disk reads with the
+ * transfers to the device.
+ */
+
+namespace eigencuda {
+
+CudaMatrix load_matrix(const std::string &filename, Index nrows, Index ncols,
+                       CudaPipeline &pipeline);
+
+}  // namespace eigencuda
+
+#endif  // MATRIX_LOADER_H_
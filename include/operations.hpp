@@ -0,0 +1,42 @@
+#ifndef OPERATIONS_H_
+#define OPERATIONS_H_
+
+/*
+ * \brief Options shared by the device (`CudaPipeline`) and host
+ * (`CpuPipeline`) implementations of the operations
+ */
+
+namespace eigencuda {
+
+// Whether an operand is used as it is or transposed
+enum class Operation { None, Transpose };
+
+// Functions applied element-wise with `apply`
+enum class UnaryFunction { Abs, Exp, Log, Sqrt, Square, Reciprocal };
+
+// Matrix norms computed by `norm`
+enum class Norm { Frobenius, MaxAbs };
+
+// Part of a symmetric result that is computed and stored
+enum class Triangle { Lower, Upper, Full };
+
+// Side of the symmetric or triangular operand in `symm`, `trsm` and `trmm`
+enum class Side { Left, Right };
+
+// Whether the diagonal of a triangular matrix is read or assumed to be ones
+enum class Diagonal { NonUnit, Unit };
+
+// Distributions of `random`: uniform in (0, 1) and standard normal
+enum class Distribution { Uniform, Normal };
+
+// Products of the slices of `gemm_split`: single precision, or the TF32
+// tensor cores whose 11 bit inputs need narrower slices
+enum class SplitArithmetic { Single, TensorFloat32 };
+
+// Largest n of the batched n x n products run by the fixed-size kernels,
+// larger matrices go through the general batched gemm
+constexpr int max_small_size = 32;
+
+}  // namespace eigencuda
+
+#endif  // OPERATIONS_H_
@@ -0,0 +1,66 @@
+#ifndef STAGING_RING_H_
+#define STAGING_RING_H_
+
+#include "cudamatrix.hpp"
+
+/*
+ * \brief Ring of pinned host buffers used to stream pageable memory
+ *
+ * Transfers from pageable memory are split in chunks. While chunk k is copied
+ * by the device, the host fills chunk k+1, so the host memcpy (or the disk
+ * reads backing a memory mapped file) overlaps with the bus transfer.
+ */
+
+namespace eigencuda {
+
+class StagingRing {
+ public:
+  static constexpr size_t default_chunks = 4;
+  static constexpr size_t default_chunk_bytes = size_t(4) << 20;
+
+  explicit StagingRing(size_t nchunks = default_chunks,
+                       size_t chunk_bytes = default_chunk_bytes);
+  ~StagingRing();
+
+  StagingRing(const StagingRing &) = delete;
+  StagingRing &operator=(const StagingRing &) = delete;
+
+  // Enqueue the copy of `bytes` from pageable host memory to the device.
+  // Returns once the host memory has been read, the device copy is ordered
+  // in `stream`
+  void upload(void *device_dst, const void *host_src, size_t bytes,
+              const cudaStream_t &stream);
+
+  // Copy `bytes` from the device to pageable host memory. Chunk k is copied
+  // into `host_dst` while chunk k+1 is transferred. Returns once `host_dst`
+  // holds the data
+  void download(void *host_dst, const void *device_src, size_t bytes,
+                const cudaStream_t &stream);
+
+  size_t nchunks() const { return _chunks.size(); };
+  size_t chunk_bytes() const { return _chunk_bytes; };
+
+ private:
+  struct Chunk {
+    char *buffer = nullptr;
+    // Recorded after the last transfer that used the buffer
+    cudaEvent_t done = nullptr;
+    // Pending copy from the buffer into the host after a download
+    char *host_dst = nullptr;
+    size_t pending_bytes = 0;
+  };
+
+  // Block until the chunk can be overwritten, delivering pending downloads
+  void wait(Chunk &chunk);
+
+  // Wait for the pending transfers and free the chunks
+  void release();
+
+  std::vector<Chunk> _chunks;
+  size_t _chunk_bytes;
+  size_t _next = 0;
+};
+
+}  // namespace eigencuda
+
+#endif  // STAGING_RING_H_
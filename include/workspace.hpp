@@ -0,0 +1,89 @@
+#ifndef WORKSPACE_H_
+#define WORKSPACE_H_
+
+#include "cudamatrix.hpp"
+
+/*
+ * \brief Scoped arena for the temporaries of an algorithm
+ *
+ * The `Workspace` reserves a single block in the device and hands out
+ * `CudaMatrix` views of it using a bump pointer.
+ */
+
+namespace eigencuda {
+
+/* \brief Host-side bookkeeping of a bump-pointer arena. It only deals with
+ * offsets, the memory itself is owned by the `Workspace`.
+ */
+class Arena {
+ public:
+  // Alignment used by cudaMalloc for its own allocations
+  static constexpr size_t default_alignment = 256;
+
+  explicit Arena(size_t capacity, size_t alignment = default_alignment);
+
+  // Reserve `bytes` and return their offset from the beginning of the block
+  size_t allocate(size_t bytes);
+
+  // Release everything that was allocated after `mark`
+  void release(size_t mark);
+  void reset() { _offset = 0; };
+
+  size_t mark() const { return _offset; };
+  size_t capacity() const { return _capacity; };
+  size_t used() const { return _offset; };
+  size_t high_water_mark() const { return _high_water_mark; };
+  size_t alignment() const { return _alignment; };
+
+ private:
+  size_t _capacity;
+  size_t _alignment;
+  size_t _offset = 0;
+  size_t _high_water_mark = 0;
+};
+
+class Workspace {
+ public:
+  // Restore the arena to its state at construction when leaving the scope
+  class Scope {
+   public:
+    explicit Scope(Workspace &workspace)
+        : _workspace{workspace}, _mark{workspace._arena.mark()} {};
+    ~Scope() { _workspace._arena.release(_mark); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    Workspace &_workspace;
+    size_t _mark;
+  };
+
+  Workspace(size_t capacity, const cudaStream_t &stream);
+
+  Workspace(const Workspace &) = delete;
+  Workspace &operator=(const Workspace &) = delete;
+
+  // Matrix living in the arena, it must not outlive the enclosing Scope
+  CudaMatrix matrix(Index nrows, Index ncols);
+
+  void reset() { _arena.reset(); };
+
+  size_t capacity() const { return _arena.capacity(); };
+  size_t used() const { return _arena.used(); };
+  size_t high_water_mark() const { return _arena.high_water_mark(); };
+
+ private:
+  using Unique_ptr_to_GPU_block = std::unique_ptr<char, void (*)(char *)>;
+
+  Arena _arena;
+  Unique_ptr_to_GPU_block _block{nullptr,
+                                 [](char *x) { checkCuda(cudaFree(x)); }};
+  cudaStream_t _stream = nullptr;
+};
+
+std::ostream &operator<<(std::ostream &os, const Workspace &workspace);
+
+}  // namespace eigencuda
+
+#endif  // WORKSPACE_H_
@@ -0,0 +1,38 @@
+#include "cudakernels.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+__global__ void batch_pointers_kernel(double *first, Index stride,
+                                      Index batch, double **pointers) {
+  Index grid_stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < batch;
+       i += grid_stride) {
+    pointers[i] = first + i * stride;
+  }
+}
+}  // namespace
+
+cudaError_t batch_pointers(double *first, Index stride, Index batch,
+                           double **pointers, cudaStream_t stream) {
+  if (batch == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks(batch);
+  batch_pointers_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      first, stride, batch, pointers);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
@@ -0,0 +1,96 @@
+/*
+ * \brief Throughput of the operations with and without the deterministic mode
+ *
+ * Usage: benchmark_deterministic [size] [repetitions]
+ * Every operation is timed in both modes on the same inputs, the last column
+ * reports whether two deterministic runs agree bit for bit.
+ */
+
+#include "cudapipeline.hpp"
+#include "cudasparse.hpp"
+#include "timing.hpp"
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaSparseMatrix;
+using eigencuda::CudaTensor;
+using eigencuda::Index;
+using eigencuda::Operation;
+using eigencuda::time_per_call;
+
+namespace {
+void report(CudaPipeline &cp, const std::string &name, double flops,
+            const std::function<void()> &call, const CudaMatrix &output,
+            int repetitions) {
+  cp.set_deterministic(false);
+  double fast = time_per_call(cp, call, repetitions);
+  cp.set_deterministic(true);
+  double pinned = time_per_call(cp, call, repetitions);
+  Eigen::MatrixXd first = output;
+  call();
+  bool reproducible = (Eigen::MatrixXd(output).array() == first.array()).all();
+  cp.set_deterministic(false);
+
+  std::cout << std::left << std::setw(14) << name << std::right
+            << std::fixed << std::setprecision(2) << std::setw(12)
+            << flops / fast * 1e-9 << std::setw(16)
+            << flops / pinned * 1e-9 << std::setw(10) << pinned / fast
+            << std::setw(14) << (reproducible ? "yes" : "no") << "\n";
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Index size = (argc > 1) ? std::atol(argv[1]) : 2048;
+  int repetitions = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+  CudaPipeline cp;
+  std::cout << "size " << size << ", " << repetitions << " repetitions\n"
+            << std::left << std::setw(14) << "operation" << std::right
+            << std::setw(12) << "GFLOP/s" << std::setw(16)
+            << "deterministic" << std::setw(10) << "slowdown"
+            << std::setw(14) << "reproducible" << "\n";
+
+  CudaMatrix A{Eigen::MatrixXd::Random(size, size), cp.get_stream()};
+  CudaMatrix B{Eigen::MatrixXd::Random(size, size), cp.get_stream()};
+  CudaMatrix C{size, size, cp.get_stream()};
+  report(cp, "gemm", 2. * size * size * size, [&]() { cp.gemm(A, B, C); }, C,
+         repetitions);
+
+  // Batches of tiny products, one specialized and one cublas size
+  for (Index n : {8, 48}) {
+    Index batch = size * size / (n * n);
+    CudaTensor T{std::vector<Eigen::MatrixXd>(batch,
+                                              Eigen::MatrixXd::Random(n, n)),
+                 cp.get_stream()};
+    CudaTensor R{n, n, batch, cp.get_stream()};
+    report(cp, "batched " + std::to_string(n), 2. * n * n * n * batch,
+           [&]() { cp.gemm_batched(T, T, R); }, R.slice(batch - 1),
+           repetitions);
+  }
+
+  // About 1% of nonzeros times a block of 32 vectors
+  Eigen::MatrixXd dense = Eigen::MatrixXd::Random(size, size);
+  dense = (dense.array().abs() > 0.99).select(dense, 0.);
+  Eigen::SparseMatrix<double> sparse = dense.sparseView();
+  CudaSparseMatrix S{sparse, cp.get_stream()};
+  CudaMatrix X{Eigen::MatrixXd::Random(size, 32), cp.get_stream()};
+  CudaMatrix Y{size, 32, cp.get_stream()};
+  report(cp, "spmm", 2. * sparse.nonZeros() * 32,
+         [&]() { cp.spmm(S, X, Y); }, Y, repetitions);
+  report(cp, "spmm^T", 2. * sparse.nonZeros() * 32,
+         [&]() { cp.spmm(S, X, Y, 1., 0., Operation::Transpose); }, Y,
+         repetitions);
+
+  CudaMatrix values{size, 1, cp.get_stream()};
+  CudaMatrix vectors{size, size, cp.get_stream()};
+  cp.syrk(A, C);
+  report(cp, "syevd", 4. / 3. * size * size * size,
+         [&]() { cp.syevd(C, values, vectors); }, values, repetitions / 4 + 1);
+  return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * \brief Throughput and accuracy of the split gemm against cublas dgemm
+ *
+ * Usage: benchmark_split_gemm [size] [repetitions]
+ * For every accuracy target and arithmetic of the slices, prints the
+ * effective GFLOP/s (2 n^3 / time), the speedup over dgemm and the largest
+ * difference from dgemm relative to the largest entries of A and B.
+ */
+
+#include "cudapipeline.hpp"
+#include "timing.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Index;
+using eigencuda::SplitArithmetic;
+using eigencuda::time_per_call;
+
+int main(int argc, char *argv[]) {
+  Index size = (argc > 1) ? std::atol(argv[1]) : 4096;
+  int repetitions = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(size, size);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(size, size);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  CudaMatrix cuma_C{size, size, cp.get_stream()};
+  double flops = 2. * size * size * size;
+  double scale = A.cwiseAbs().maxCoeff() * B.cwiseAbs().maxCoeff();
+
+  double reference =
+      time_per_call(cp, [&]() { cp.gemm(cuma_A, cuma_B, cuma_C); },
+                    repetitions);
+  Eigen::MatrixXd C = cuma_C;
+  std::cout << "size " << size << ", " << repetitions << " repetitions\n"
+            << std::left << std::setw(14) << "operation" << std::right
+            << std::setw(6) << "bits" << std::setw(12) << "GFLOP/s"
+            << std::setw(10) << "speedup" << std::setw(14) << "difference"
+            << "\n"
+            << std::left << std::setw(14) << "dgemm" << std::right
+            << std::setw(6) << 53 << std::fixed << std::setprecision(2)
+            << std::setw(12) << flops / reference * 1e-9 << std::setw(10)
+            << 1. << std::setw(14) << 0. << "\n";
+
+  for (SplitArithmetic arithmetic :
+       {SplitArithmetic::Single, SplitArithmetic::TensorFloat32}) {
+    for (int bits : {53, 45, 36, 24}) {
+      double seconds = time_per_call(
+          cp,
+          [&]() { cp.gemm_split(cuma_A, cuma_B, cuma_C, bits, arithmetic); },
+          repetitions);
+      double difference =
+          (Eigen::MatrixXd(cuma_C) - C).cwiseAbs().maxCoeff() / scale;
+      std::cout << std::left << std::setw(14)
+                << (arithmetic == SplitArithmetic::Single ? "split fp32"
+                                                          : "split tf32")
+                << std::right << std::setw(6) << bits << std::fixed
+                << std::setprecision(2) << std::setw(12)
+                << flops / seconds * 1e-9 << std::setw(10)
+                << reference / seconds << std::scientific
+                << std::setprecision(2) << std::setw(14) << difference
+                << "\n";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCHMARK_TIMING_H_
+#define BENCHMARK_TIMING_H_
+
+#include "cudapipeline.hpp"
+#include <chrono>
+#include <functional>
+
+namespace eigencuda {
+
+// Average seconds per call of an operation enqueued in the pipeline, after a
+// warm up call
+inline double time_per_call(CudaPipeline &cp, const std::function<void()> &call,
+                            int repetitions) {
+  call();
+  cp.synchronize();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; i++) {
+    call();
+  }
+  cp.synchronize();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / repetitions;
+}
+
+}  // namespace eigencuda
+
+#endif  // BENCHMARK_TIMING_H_
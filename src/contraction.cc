@@ -0,0 +1,363 @@
+#include "contraction.hpp"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace eigencuda {
+
+Index shape_size(const Shape &shape) {
+  Index size = 1;
+  for (Index dim : shape) {
+    size *= dim;
+  }
+  return size;
+}
+
+namespace {
+std::string strip_spaces(const std::string &text) {
+  std::string result;
+  for (char c : text) {
+    if (!std::isspace(static_cast<unsigned char>(c))) {
+      result += c;
+    }
+  }
+  return result;
+}
+
+void throw_if_invalid_labels(const std::string &labels) {
+  for (std::size_t i = 0; i < labels.size(); i++) {
+    if (!std::isalpha(static_cast<unsigned char>(labels[i]))) {
+      throw std::runtime_error("Invalid index '" + labels.substr(i, 1) +
+                               "' in contraction, indices are letters");
+    }
+    if (labels.find(labels[i], i + 1) != std::string::npos) {
+      throw std::runtime_error("Repeated index '" + labels.substr(i, 1) +
+                               "' in " + labels +
+                               ", diagonals are not supported");
+    }
+  }
+  if (labels.size() > ContractionPlan::max_rank) {
+    throw std::runtime_error("Tensor " + labels + " exceeds the maximum rank");
+  }
+}
+
+bool contains(const std::string &labels, char label) {
+  return labels.find(label) != std::string::npos;
+}
+}  // namespace
+
+ContractionPlan::ContractionPlan(const std::string &expression,
+                                 const std::vector<Shape> &shapes)
+    : _input_shapes{shapes} {
+  parse(expression);
+  if (shapes.size() != _input_labels.size()) {
+    throw std::runtime_error("The contraction " + expression + " requires " +
+                             std::to_string(_input_labels.size()) +
+                             " operands");
+  }
+  for (std::size_t i = 0; i < shapes.size(); i++) {
+    const std::string &labels = _input_labels[i];
+    if (shapes[i].size() != labels.size()) {
+      throw std::runtime_error("The rank of operand " + std::to_string(i) +
+                               " does not match " + labels);
+    }
+    for (std::size_t d = 0; d < labels.size(); d++) {
+      Index &dim = _dims[labels[d]];
+      if (dim >= 0 && dim != shapes[i][d]) {
+        throw std::runtime_error("Inconsistent dimension of index '" +
+                                 labels.substr(d, 1) + "'");
+      }
+      dim = shapes[i][d];
+    }
+  }
+  _result_shape = dims_of(_result_labels);
+  plan();
+}
+
+void ContractionPlan::parse(const std::string &expression) {
+  std::string text = strip_spaces(expression);
+  std::size_t arrow = text.find("->");
+  std::istringstream inputs(text.substr(0, arrow));
+  std::string labels;
+  while (std::getline(inputs, labels, ',')) {
+    throw_if_invalid_labels(labels);
+    _input_labels.push_back(labels);
+  }
+  if (_input_labels.empty()) {
+    throw std::runtime_error("Empty contraction");
+  }
+
+  std::string all_labels;
+  for (const std::string &input : _input_labels) {
+    all_labels += input;
+  }
+  if (arrow == std::string::npos) {
+    // Implicit result: the indices appearing only once, sorted
+    for (char label : all_labels) {
+      if (std::count(all_labels.begin(), all_labels.end(), label) == 1) {
+        _result_labels += label;
+      }
+    }
+    std::sort(_result_labels.begin(), _result_labels.end());
+  } else {
+    _result_labels = text.substr(arrow + 2);
+    throw_if_invalid_labels(_result_labels);
+    for (char label : _result_labels) {
+      if (!contains(all_labels, label)) {
+        throw std::runtime_error("The result index '" + std::string(1, label) +
+                                 "' is missing from the operands");
+      }
+    }
+  }
+}
+
+Shape ContractionPlan::dims_of(const std::string &labels) const {
+  Shape dims;
+  for (char label : labels) {
+    dims.push_back(_dims[label]);
+  }
+  return dims;
+}
+
+Index ContractionPlan::size_of(const std::string &labels) const {
+  return shape_size(dims_of(labels));
+}
+
+bool ContractionPlan::is_needed(char label, const std::vector<Node> &nodes,
+                                const std::vector<int> &skip) const {
+  if (contains(_result_labels, label)) {
+    return true;
+  }
+  for (std::size_t i = 0; i < nodes.size(); i++) {
+    bool skipped = std::find(skip.begin(), skip.end(), int(i)) != skip.end();
+    if (!skipped && contains(nodes[i].labels, label)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int ContractionPlan::new_slot(Index size) {
+  _slot_sizes.push_back(size);
+  return int(_slot_sizes.size()) - 1;
+}
+
+void ContractionPlan::plan() {
+  std::vector<Node> nodes;
+  for (std::size_t i = 0; i < _input_labels.size(); i++) {
+    nodes.push_back(Node{_input_labels[i], int(i)});
+    _slot_sizes.push_back(size_of(_input_labels[i]));
+  }
+
+  // Indices of a single operand missing from the result are summed first
+  for (std::size_t i = 0; i < nodes.size(); i++) {
+    std::string summed;
+    for (char label : nodes[i].labels) {
+      if (!is_needed(label, nodes, {int(i)})) {
+        summed += label;
+      }
+    }
+    if (!summed.empty()) {
+      nodes[i] = sum(nodes[i], summed);
+    }
+  }
+
+  // Greedily contract the pair with the fewest operations, breaking ties
+  // with the size of the intermediate result
+  while (nodes.size() > 1) {
+    std::size_t best_i = 0;
+    std::size_t best_j = 1;
+    Index best_cost = -1;
+    Index best_size = -1;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+      for (std::size_t j = i + 1; j < nodes.size(); j++) {
+        std::string all = nodes[i].labels;
+        std::string kept;
+        for (char label : nodes[j].labels) {
+          if (!contains(all, label)) {
+            all += label;
+          }
+        }
+        for (char label : all) {
+          if (is_needed(label, nodes, {int(i), int(j)})) {
+            kept += label;
+          }
+        }
+        Index cost = size_of(all);
+        Index size = size_of(kept);
+        if (best_cost < 0 || cost < best_cost ||
+            (cost == best_cost && size < best_size)) {
+          best_i = i;
+          best_j = j;
+          best_cost = cost;
+          best_size = size;
+        }
+      }
+    }
+    Node result = contract(nodes[best_i], nodes[best_j], nodes,
+                           {int(best_i), int(best_j)});
+    nodes.erase(nodes.begin() + best_j);
+    nodes.erase(nodes.begin() + best_i);
+    nodes.push_back(result);
+  }
+
+  // The result always gets its own slot, even if it is a plain copy
+  const Node &last = nodes.front();
+  if (last.labels != _result_labels || last.slot < int(_input_labels.size())) {
+    permute(last, _result_labels);
+  }
+}
+
+ContractionPlan::Node ContractionPlan::permute(const Node &node,
+                                               const std::string &labels) {
+  ContractionStep step;
+  step.kind = ContractionStep::Kind::Permute;
+  step.input = node.slot;
+  step.dims = dims_of(node.labels);
+  for (char label : labels) {
+    step.permutation.push_back(int(node.labels.find(label)));
+  }
+  step.output = new_slot(size_of(labels));
+  _steps.push_back(step);
+  return Node{labels, step.output};
+}
+
+ContractionPlan::Node ContractionPlan::sum(const Node &node,
+                                           const std::string &summed) {
+  std::string kept;
+  for (char label : node.labels) {
+    if (!contains(summed, label)) {
+      kept += label;
+    }
+  }
+  Node source = node;
+  if (source.labels != kept + summed) {
+    source = permute(source, kept + summed);
+  }
+  ContractionStep step;
+  step.kind = ContractionStep::Kind::Sum;
+  step.input = source.slot;
+  step.m = size_of(kept);
+  step.k = size_of(summed);
+  step.output = new_slot(step.m);
+  _steps.push_back(step);
+  _flops += double(step.m) * double(step.k);
+  return Node{kept, step.output};
+}
+
+ContractionPlan::Node ContractionPlan::contract(const Node &A, const Node &B,
+                                                const std::vector<Node> &nodes,
+                                                const std::vector<int> &pair) {
+  std::string batch;
+  std::string contracted;
+  std::string free_A;
+  std::string free_B;
+  for (char label : A.labels) {
+    if (!contains(B.labels, label)) {
+      free_A += label;
+    } else if (is_needed(label, nodes, pair)) {
+      batch += label;
+    } else {
+      contracted += label;
+    }
+  }
+  for (char label : B.labels) {
+    if (!contains(A.labels, label)) {
+      free_B += label;
+    }
+  }
+
+  ContractionStep step;
+  step.kind = ContractionStep::Kind::Gemm;
+  // A transposed gemm operand avoids a permutation
+  Node source_A = A;
+  if (A.labels == contracted + free_A + batch) {
+    step.op_A = Operation::Transpose;
+  } else if (A.labels != free_A + contracted + batch) {
+    source_A = permute(A, free_A + contracted + batch);
+  }
+  Node source_B = B;
+  if (B.labels == free_B + contracted + batch) {
+    step.op_B = Operation::Transpose;
+  } else if (B.labels != contracted + free_B + batch) {
+    source_B = permute(B, contracted + free_B + batch);
+  }
+  step.input = source_A.slot;
+  step.other = source_B.slot;
+  step.m = size_of(free_A);
+  step.n = size_of(free_B);
+  step.k = size_of(contracted);
+  step.batch = size_of(batch);
+  step.output = new_slot(step.m * step.n * step.batch);
+  _steps.push_back(step);
+  _flops += 2. * double(step.m) * double(step.n) * double(step.k) *
+            double(step.batch);
+  return Node{free_A + free_B + batch, step.output};
+}
+
+Index ContractionPlan::result_rows() const {
+  return _result_shape.empty() ? 1 : _result_shape.front();
+}
+
+Index ContractionPlan::result_cols() const {
+  if (_result_shape.empty()) {
+    return 1;
+  }
+  return shape_size(Shape(_result_shape.begin() + 1, _result_shape.end()));
+}
+
+void ContractionPlan::throw_if_incompatible(
+    const std::vector<Shape> &shapes) const {
+  if (shapes != _input_shapes) {
+    throw std::runtime_error(
+        "The operands do not have the shapes of the contraction plan");
+  }
+}
+
+std::ostream &operator<<(std::ostream &os, const ContractionPlan &plan) {
+  for (std::size_t i = 0; i < plan._input_labels.size(); i++) {
+    os << (i == 0 ? "" : ",") << plan._input_labels[i];
+  }
+  os << "->" << plan._result_labels << ": " << plan.flops() << " flops\n";
+  for (const ContractionStep &step : plan.steps()) {
+    switch (step.kind) {
+      case ContractionStep::Kind::Permute:
+        os << "  permute " << step.input << " -> " << step.output << "\n";
+        break;
+      case ContractionStep::Kind::Sum:
+        os << "  sum " << step.input << " (" << step.m << " x " << step.k
+           << ") -> " << step.output << "\n";
+        break;
+      case ContractionStep::Kind::Gemm:
+        os << "  gemm " << step.input
+           << (step.op_A == Operation::Transpose ? "^T" : "") << " * "
+           << step.other << (step.op_B == Operation::Transpose ? "^T" : "")
+           << " (" << step.m << " x " << step.n << " x " << step.k << ", "
+           << step.batch << " batches) -> " << step.output << "\n";
+        break;
+    }
+  }
+  return os;
+}
+
+void permute(const double *A, const Shape &dims,
+             const std::vector<int> &permutation, double *B) {
+  std::size_t rank = dims.size();
+  Shape strides(rank, 1);
+  for (std::size_t d = 1; d < rank; d++) {
+    strides[d] = strides[d - 1] * dims[d - 1];
+  }
+  Index size = shape_size(dims);
+  for (Index i = 0; i < size; i++) {
+    Index rest = i;
+    Index offset = 0;
+    for (std::size_t d = 0; d < rank; d++) {
+      Index dim = dims[permutation[d]];
+      offset += (rest % dim) * strides[permutation[d]];
+      rest /= dim;
+    }
+    B[i] = A[offset];
+  }
+}
+
+}  // namespace eigencuda
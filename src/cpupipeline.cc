@@ -0,0 +1,961 @@
+#include "cpupipeline.hpp"
+#include "philox.hpp"
+#include "split.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace eigencuda {
+
+namespace {
+void throw_if_shapes_differ(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                            const std::string &operation) {
+  if (A.rows() != B.rows() || A.cols() != B.cols()) {
+    throw std::runtime_error("Shape mismatch in " + operation);
+  }
+}
+
+template <int N>
+void small_gemm(const double *A, const double *B, double *C,
+                Eigen::Index batch) {
+  using Small = Eigen::Matrix<double, N, N>;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    Eigen::Map<Small> C_i(C + i * N * N);
+    C_i.noalias() = Eigen::Map<const Small>(A + i * N * N) *
+                    Eigen::Map<const Small>(B + i * N * N);
+  }
+}
+
+// Map the runtime size to the product specialized for it
+template <int N>
+struct SmallGemm {
+  static void run(Eigen::Index n, const double *A, const double *B, double *C,
+                  Eigen::Index batch) {
+    if (n == N) {
+      small_gemm<N>(A, B, C, batch);
+    } else {
+      SmallGemm<N - 1>::run(n, A, B, C, batch);
+    }
+  }
+};
+
+template <>
+struct SmallGemm<0> {
+  static void run(Eigen::Index, const double *, const double *, double *,
+                  Eigen::Index) {}
+};
+
+// Exact zero pivot, the singularity reported by getrf with info > 0
+template <typename LU>
+bool has_zero_pivot(const LU &lu) {
+  return (lu.matrixLU().diagonal().array() == 0.).any();
+}
+
+// Invert the n x n matrices of A, returning the first singular one (batch
+// when all of them are invertible). N is n or Eigen::Dynamic
+template <int N>
+Eigen::Index inverse_batch(const double *A, double *inverse, Eigen::Index n,
+                           Eigen::Index batch) {
+  using Square = Eigen::Matrix<double, N, N>;
+  Eigen::Index first_singular = batch;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min : first_singular)
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    Eigen::Map<const Square> A_i(A + i * n * n, n, n);
+    Eigen::PartialPivLU<Square> lu(A_i);
+    if (has_zero_pivot(lu)) {
+      first_singular = std::min(first_singular, i);
+    } else {
+      Eigen::Map<Square>(inverse + i * n * n, n, n) = lu.inverse();
+    }
+  }
+  return first_singular;
+}
+
+void throw_if_not_side_by_side(const Eigen::MatrixXd &A, Eigen::Index batch,
+                               const std::string &operation) {
+  if (batch < 0 || A.cols() != A.rows() * batch) {
+    throw std::runtime_error(operation +
+                             " requires square matrices side by side");
+  }
+}
+
+void throw_if_cannot_solve(Eigen::Index rows, std::size_t batch,
+                           const Eigen::MatrixXd &B) {
+  if (batch == 0 || B.rows() != rows || B.cols() % Eigen::Index(batch) != 0) {
+    throw std::runtime_error("Shape mismatch in the right hand sides");
+  }
+}
+
+void throw_if_batch_failed(Eigen::Index failed, Eigen::Index batch,
+                           const std::string &problem) {
+  if (failed < batch) {
+    throw std::runtime_error("Matrix " + std::to_string(failed) +
+                             " of the batch " + problem);
+  }
+}
+
+// Power of two scales of the rows (by_rows) or the columns of A
+Eigen::VectorXd split_scales(const Eigen::MatrixXd &A, bool by_rows) {
+  Eigen::Index count = by_rows ? A.rows() : A.cols();
+  Eigen::VectorXd scales(count);
+  for (Eigen::Index i = 0; i < count; i++) {
+    double max_abs = 0.;
+    if (A.size() > 0) {
+      max_abs = by_rows ? A.row(i).cwiseAbs().maxCoeff()
+                        : A.col(i).cwiseAbs().maxCoeff();
+    }
+    scales(i) = split::scale_of(max_abs);
+  }
+  return scales;
+}
+
+// The same slices as the split kernels
+std::vector<Eigen::MatrixXf> split_slices(const Eigen::MatrixXd &A,
+                                          const Eigen::VectorXd &scales,
+                                          bool by_rows, int width,
+                                          int slices) {
+  std::vector<Eigen::MatrixXf> result(slices,
+                                      Eigen::MatrixXf(A.rows(), A.cols()));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (Eigen::Index j = 0; j < A.cols(); j++) {
+    for (Eigen::Index i = 0; i < A.rows(); i++) {
+      double x = A(i, j) / scales(by_rows ? i : j);
+      for (int level = 0; level < slices; level++) {
+        result[level](i, j) = split::extract_slice(x, level, width);
+      }
+    }
+  }
+  return result;
+}
+}  // namespace
+
+void CpuPipeline::gemm(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                       Eigen::MatrixXd &C) const {
+  if (A.cols() != B.rows()) {
+    throw std::runtime_error("Shape mismatch in gemm");
+  }
+  C.noalias() = A * B;
+}
+
+void CpuPipeline::gemm_batched(const Eigen::MatrixXd &A,
+                               const Eigen::MatrixXd &B, Eigen::MatrixXd &C,
+                               Eigen::Index batch) const {
+  if (batch < 1 || A.cols() % batch != 0 || B.cols() % batch != 0 ||
+      A.cols() / batch != B.rows()) {
+    throw std::runtime_error("Shape mismatch in batched gemm");
+  }
+  Eigen::Index rows = A.rows();
+  Eigen::Index inner = B.rows();
+  Eigen::Index cols = B.cols() / batch;
+  C.resize(rows, cols * batch);
+  if (rows == inner && cols == rows && rows > 0 && rows <= max_small_size) {
+    SmallGemm<max_small_size>::run(rows, A.data(), B.data(), C.data(), batch);
+    return;
+  }
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    C.middleCols(i * cols, cols).noalias() =
+        A.middleCols(i * inner, inner) * B.middleCols(i * cols, cols);
+  }
+}
+
+void CpuPipeline::gemm_split(const Eigen::MatrixXd &A,
+                             const Eigen::MatrixXd &B, Eigen::MatrixXd &C,
+                             int bits, SplitArithmetic arithmetic) const {
+  if (A.cols() != B.rows()) {
+    throw std::runtime_error("Shape mismatch in split gemm");
+  }
+  if (bits < 1 || bits > 53) {
+    throw std::runtime_error("The split gemm accuracy must be 1 to 53 bits");
+  }
+  Eigen::Index k = A.cols();
+  int width = split::slice_width(k, arithmetic == SplitArithmetic::TensorFloat32
+                                        ? split::tf32_bits
+                                        : split::float_bits);
+  if (width < 1) {
+    throw std::runtime_error("The inner dimension is too large to split");
+  }
+  int slices = split::number_of_slices(bits, k, width);
+  Eigen::VectorXd row_scales = split_scales(A, true);
+  Eigen::VectorXd col_scales = split_scales(B, false);
+  std::vector<Eigen::MatrixXf> slices_A =
+      split_slices(A, row_scales, true, width, slices);
+  std::vector<Eigen::MatrixXf> slices_B =
+      split_slices(B, col_scales, false, width, slices);
+
+  // Every product is exact, so it matches the device one bitwise
+  Eigen::MatrixXd scales = row_scales * col_scales.transpose();
+  C = Eigen::MatrixXd::Zero(A.rows(), B.cols());
+  Eigen::MatrixXf product(A.rows(), B.cols());
+  for (int level = slices - 1; level >= 0; level--) {
+    for (int i = 0; i <= level; i++) {
+      product.noalias() = slices_A[i] * slices_B[level - i];
+      C.array() += scales.array() * product.cast<double>().array();
+    }
+  }
+}
+
+void CpuPipeline::gemv(const Eigen::MatrixXd &A, const Eigen::VectorXd &x,
+                       Eigen::VectorXd &y, double alpha, double beta,
+                       Operation op) const {
+  Eigen::Index rows_A = (op == Operation::None) ? A.rows() : A.cols();
+  Eigen::Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != x.size()) {
+    throw std::runtime_error("Shape mismatch in gemv");
+  }
+  if (beta == 0.) {
+    y = Eigen::VectorXd::Zero(rows_A);
+  } else if (y.size() != rows_A) {
+    throw std::runtime_error("Shape mismatch in gemv accumulation");
+  } else {
+    y *= beta;
+  }
+  if (op == Operation::None) {
+    y.noalias() += alpha * A * x;
+  } else {
+    y.noalias() += alpha * A.transpose() * x;
+  }
+}
+
+void CpuPipeline::gemv_batched(const Eigen::MatrixXd &A,
+                               const Eigen::MatrixXd &X, Eigen::MatrixXd &Y,
+                               Operation op) const {
+  Eigen::Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != X.rows()) {
+    throw std::runtime_error("Shape mismatch in gemv batched");
+  }
+  if (op == Operation::None) {
+    Y.noalias() = A * X;
+  } else {
+    Y.noalias() = A.transpose() * X;
+  }
+}
+
+void CpuPipeline::spmm(const Eigen::SparseMatrix<double> &A,
+                       const Eigen::MatrixXd &B, Eigen::MatrixXd &C,
+                       double alpha, double beta, Operation op) const {
+  Eigen::Index rows_A = (op == Operation::None) ? A.rows() : A.cols();
+  Eigen::Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != B.rows()) {
+    throw std::runtime_error("Shape mismatch in spmm");
+  }
+  if (beta == 0.) {
+    C = Eigen::MatrixXd::Zero(rows_A, B.cols());
+  } else if (C.rows() != rows_A || C.cols() != B.cols()) {
+    throw std::runtime_error("Shape mismatch in spmm accumulation");
+  } else {
+    C *= beta;
+  }
+  if (op == Operation::None) {
+    C.noalias() += alpha * A * B;
+  } else {
+    C.noalias() += alpha * A.transpose() * B;
+  }
+}
+
+void CpuPipeline::spmv(const Eigen::SparseMatrix<double> &A,
+                       const Eigen::VectorXd &x, Eigen::VectorXd &y,
+                       double alpha, double beta, Operation op) const {
+  Eigen::Index rows_A = (op == Operation::None) ? A.rows() : A.cols();
+  Eigen::Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != x.size()) {
+    throw std::runtime_error("Shape mismatch in spmv");
+  }
+  if (beta == 0.) {
+    y = Eigen::VectorXd::Zero(rows_A);
+  } else if (y.size() != rows_A) {
+    throw std::runtime_error("Shape mismatch in spmv accumulation");
+  } else {
+    y *= beta;
+  }
+  if (op == Operation::None) {
+    y.noalias() += alpha * A * x;
+  } else {
+    y.noalias() += alpha * A.transpose() * x;
+  }
+}
+
+void CpuPipeline::einsum(const std::string &expression,
+                         const std::vector<HostOperand> &operands,
+                         Eigen::MatrixXd &result) const {
+  std::vector<Shape> shapes;
+  for (const HostOperand &operand : operands) {
+    shapes.push_back(operand.shape);
+  }
+  contract(ContractionPlan{expression, shapes}, operands, result);
+}
+
+namespace {
+// One matrix of a batch, transposed if op says so
+template <typename Map>
+void batch_product(const Map &A, Operation op_A, const Map &B,
+                   Operation op_B, Eigen::Map<Eigen::MatrixXd> C) {
+  if (op_A == Operation::None && op_B == Operation::None) {
+    C.noalias() = A * B;
+  } else if (op_A == Operation::None) {
+    C.noalias() = A * B.transpose();
+  } else if (op_B == Operation::None) {
+    C.noalias() = A.transpose() * B;
+  } else {
+    C.noalias() = A.transpose() * B.transpose();
+  }
+}
+}  // namespace
+
+void CpuPipeline::contract(const ContractionPlan &plan,
+                           const std::vector<HostOperand> &operands,
+                           Eigen::MatrixXd &result) const {
+  std::vector<Shape> shapes;
+  std::vector<double *> slots;
+  for (const HostOperand &operand : operands) {
+    if (operand.matrix.size() != shape_size(operand.shape)) {
+      throw std::runtime_error(
+          "The shape of an operand does not match its size");
+    }
+    shapes.push_back(operand.shape);
+    slots.push_back(const_cast<double *>(operand.matrix.data()));
+  }
+  plan.throw_if_incompatible(shapes);
+
+  const std::vector<Eigen::Index> &sizes = plan.slot_sizes();
+  std::vector<Eigen::VectorXd> temporaries(sizes.size());
+  for (int slot = int(slots.size()); slot < plan.result_slot(); slot++) {
+    temporaries[slot].resize(sizes[slot]);
+    slots.push_back(temporaries[slot].data());
+  }
+  result.resize(plan.result_rows(), plan.result_cols());
+  slots.push_back(result.data());
+
+  using ConstMap = Eigen::Map<const Eigen::MatrixXd>;
+  for (const ContractionStep &step : plan.steps()) {
+    const double *A = slots[step.input];
+    double *C = slots[step.output];
+    switch (step.kind) {
+      case ContractionStep::Kind::Permute:
+        permute(A, step.dims, step.permutation, C);
+        break;
+      case ContractionStep::Kind::Sum:
+        Eigen::Map<Eigen::VectorXd>(C, step.m) =
+            ConstMap(A, step.m, step.k).rowwise().sum();
+        break;
+      case ContractionStep::Kind::Gemm: {
+        bool trans_A = (step.op_A == Operation::Transpose);
+        bool trans_B = (step.op_B == Operation::Transpose);
+        const double *B = slots[step.other];
+        for (Eigen::Index b = 0; b < step.batch; b++) {
+          ConstMap matrix_A(A + b * step.m * step.k, trans_A ? step.k : step.m,
+                            trans_A ? step.m : step.k);
+          ConstMap matrix_B(B + b * step.k * step.n, trans_B ? step.n : step.k,
+                            trans_B ? step.k : step.n);
+          batch_product(matrix_A, step.op_A, matrix_B, step.op_B,
+                        Eigen::Map<Eigen::MatrixXd>(C + b * step.m * step.n,
+                                                    step.m, step.n));
+        }
+        break;
+      }
+    }
+  }
+}
+
+void CpuPipeline::chain_product(const ChainOperands<Eigen::MatrixXd> &operands,
+                                Eigen::MatrixXd &result) const {
+  chain_product(ChainPlan{ChainPlan::dims_of(operands)}, operands, result);
+}
+
+void CpuPipeline::chain_product(const ChainPlan &plan,
+                                const ChainOperands<Eigen::MatrixXd> &operands,
+                                Eigen::MatrixXd &result) const {
+  plan.throw_if_incompatible(ChainPlan::dims_of(operands));
+  if (plan.steps().empty()) {
+    result = operands.front();
+    return;
+  }
+  std::vector<double *> slots;
+  for (const Eigen::MatrixXd &operand : operands) {
+    slots.push_back(const_cast<double *>(operand.data()));
+  }
+  const std::vector<Eigen::Index> &sizes = plan.slot_sizes();
+  std::vector<Eigen::VectorXd> temporaries(sizes.size());
+  for (int slot = int(slots.size()); slot < plan.result_slot(); slot++) {
+    temporaries[slot].resize(sizes[slot]);
+    slots.push_back(temporaries[slot].data());
+  }
+  result.resize(plan.dims().front(), plan.dims().back());
+  slots.push_back(result.data());
+
+  using ConstMap = Eigen::Map<const Eigen::MatrixXd>;
+  for (const ChainStep &step : plan.steps()) {
+    Eigen::Map<Eigen::MatrixXd>(slots[step.output], step.m, step.n).noalias() =
+        ConstMap(slots[step.left], step.m, step.k) *
+        ConstMap(slots[step.right], step.k, step.n);
+  }
+}
+
+void CpuPipeline::scale(Eigen::MatrixXd &A, double alpha) const { A *= alpha; }
+
+void CpuPipeline::axpy(double alpha, const Eigen::MatrixXd &X,
+                       Eigen::MatrixXd &Y) const {
+  throw_if_shapes_differ(X, Y, "axpy");
+  Y += alpha * X;
+}
+
+void CpuPipeline::add(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                      Eigen::MatrixXd &C) const {
+  throw_if_shapes_differ(A, B, "add");
+  C = A + B;
+}
+
+void CpuPipeline::hadamard_product(const Eigen::MatrixXd &A,
+                                   const Eigen::MatrixXd &B,
+                                   Eigen::MatrixXd &C) const {
+  throw_if_shapes_differ(A, B, "hadamard product");
+  C = A.cwiseProduct(B);
+}
+
+void CpuPipeline::hadamard_division(const Eigen::MatrixXd &A,
+                                    const Eigen::MatrixXd &B,
+                                    Eigen::MatrixXd &C) const {
+  throw_if_shapes_differ(A, B, "hadamard division");
+  C = A.cwiseQuotient(B);
+}
+
+void CpuPipeline::apply(Eigen::MatrixXd &A, UnaryFunction function) const {
+  switch (function) {
+    case UnaryFunction::Abs:
+      A = A.array().abs();
+      break;
+    case UnaryFunction::Exp:
+      A = A.array().exp();
+      break;
+    case UnaryFunction::Log:
+      A = A.array().log();
+      break;
+    case UnaryFunction::Sqrt:
+      A = A.array().sqrt();
+      break;
+    case UnaryFunction::Square:
+      A = A.array().square();
+      break;
+    case UnaryFunction::Reciprocal:
+      A = A.array().inverse();
+      break;
+  }
+}
+
+void CpuPipeline::random(Eigen::MatrixXd &A, Distribution distribution,
+                         std::uint64_t seed, std::uint64_t subsequence) const {
+  double *data = A.data();
+  Eigen::Index size = A.size();
+  Eigen::Index pairs = (size + 1) / 2;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (Eigen::Index i = 0; i < pairs; i++) {
+    double x0;
+    double x1;
+    if (distribution == Distribution::Normal) {
+      philox::normal_pair(seed, subsequence, i, x0, x1);
+    } else {
+      philox::uniform_pair(seed, subsequence, i, x0, x1);
+    }
+    data[2 * i] = x0;
+    if (2 * i + 1 < size) {
+      data[2 * i + 1] = x1;
+    }
+  }
+}
+
+double CpuPipeline::norm(const Eigen::MatrixXd &A, Norm type) const {
+  return (type == Norm::Frobenius) ? A.norm() : A.lpNorm<Eigen::Infinity>();
+}
+
+double CpuPipeline::sum(const Eigen::MatrixXd &A) const { return A.sum(); }
+
+double CpuPipeline::trace(const Eigen::MatrixXd &A) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("The trace is only defined for square matrices");
+  }
+  return A.trace();
+}
+
+double CpuPipeline::dot(const Eigen::MatrixXd &A,
+                        const Eigen::MatrixXd &B) const {
+  throw_if_shapes_differ(A, B, "dot");
+  return A.cwiseProduct(B).sum();
+}
+
+Eigen::VectorXd CpuPipeline::column_norms(const Eigen::MatrixXd &A) const {
+  return A.colwise().norm().transpose();
+}
+
+namespace {
+// C = U * V^T + V * U^T in the given triangle
+template <unsigned int Mode, typename U, typename V>
+void rank_2k_update(const U &u, const V &v, Eigen::MatrixXd &C) {
+  C.triangularView<Mode>() = u * v.transpose();
+  C.triangularView<Mode>() += v * u.transpose();
+}
+
+template <typename U, typename V>
+void rank_2k_update(const U &u, const V &v, Eigen::MatrixXd &C,
+                    Triangle triangle) {
+  if (triangle == Triangle::Upper) {
+    rank_2k_update<Eigen::Upper>(u, v, C);
+  } else {
+    rank_2k_update<Eigen::Lower>(u, v, C);
+  }
+}
+
+void mirror_lower_triangle(Eigen::MatrixXd &C) {
+  C.triangularView<Eigen::StrictlyUpper>() = C.transpose();
+}
+}  // namespace
+
+void CpuPipeline::syrk(const Eigen::MatrixXd &A, Eigen::MatrixXd &C,
+                       Triangle triangle, Operation op) const {
+  Eigen::Index n = (op == Operation::None) ? A.rows() : A.cols();
+  C = Eigen::MatrixXd::Zero(n, n);
+  if (triangle == Triangle::Upper) {
+    if (op == Operation::None) {
+      C.selfadjointView<Eigen::Upper>().rankUpdate(A);
+    } else {
+      C.selfadjointView<Eigen::Upper>().rankUpdate(A.transpose());
+    }
+  } else {
+    if (op == Operation::None) {
+      C.selfadjointView<Eigen::Lower>().rankUpdate(A);
+    } else {
+      C.selfadjointView<Eigen::Lower>().rankUpdate(A.transpose());
+    }
+  }
+  if (triangle == Triangle::Full) {
+    mirror_lower_triangle(C);
+  }
+}
+
+void CpuPipeline::syr2k(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                        Eigen::MatrixXd &C, Triangle triangle,
+                        Operation op) const {
+  throw_if_shapes_differ(A, B, "syr2k");
+  Eigen::Index n = (op == Operation::None) ? A.rows() : A.cols();
+  C = Eigen::MatrixXd::Zero(n, n);
+  if (op == Operation::None) {
+    rank_2k_update(A, B, C, triangle);
+  } else {
+    rank_2k_update(A.transpose(), B.transpose(), C, triangle);
+  }
+  if (triangle == Triangle::Full) {
+    mirror_lower_triangle(C);
+  }
+}
+
+void CpuPipeline::symm(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                       Eigen::MatrixXd &C, Side side) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("symm requires a square symmetric matrix");
+  }
+  Eigen::Index inner = (side == Side::Left) ? B.rows() : B.cols();
+  if (inner != A.rows()) {
+    throw std::runtime_error("Shape mismatch in symm");
+  }
+  if (side == Side::Left) {
+    C.noalias() = A.selfadjointView<Eigen::Lower>() * B;
+  } else {
+    C.noalias() = B * A.selfadjointView<Eigen::Lower>();
+  }
+}
+
+namespace {
+void throw_if_not_triangular(const Eigen::MatrixXd &A, Eigen::Index inner,
+                             Triangle triangle, const std::string &operation) {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error(operation + " requires a square matrix");
+  }
+  if (triangle == Triangle::Full) {
+    throw std::runtime_error(operation +
+                             " requires the lower or the upper triangle");
+  }
+  if (inner != A.rows()) {
+    throw std::runtime_error("Shape mismatch in " + operation);
+  }
+}
+
+// Call f with the triangular view of op(A) selected at runtime
+template <unsigned int Mode, typename F>
+void with_triangle(const Eigen::MatrixXd &A, Operation op, F f) {
+  if (op == Operation::None) {
+    f(A.triangularView<Mode>());
+  } else {
+    f(A.triangularView<Mode>().transpose());
+  }
+}
+
+template <typename F>
+void with_triangle(const Eigen::MatrixXd &A, Triangle triangle,
+                   Operation op, Diagonal diagonal, F f) {
+  bool unit = (diagonal == Diagonal::Unit);
+  if (triangle == Triangle::Lower && unit) {
+    with_triangle<Eigen::UnitLower>(A, op, f);
+  } else if (triangle == Triangle::Lower) {
+    with_triangle<Eigen::Lower>(A, op, f);
+  } else if (unit) {
+    with_triangle<Eigen::UnitUpper>(A, op, f);
+  } else {
+    with_triangle<Eigen::Upper>(A, op, f);
+  }
+}
+}  // namespace
+
+void CpuPipeline::trsm(const Eigen::MatrixXd &A, Eigen::MatrixXd &B,
+                       Side side, Triangle triangle, Operation op,
+                       Diagonal diagonal, double alpha) const {
+  Eigen::Index inner = (side == Side::Left) ? B.rows() : B.cols();
+  throw_if_not_triangular(A, inner, triangle, "trsm");
+  B *= alpha;
+  with_triangle(A, triangle, op, diagonal, [&](const auto &T) {
+    if (side == Side::Left) {
+      T.solveInPlace(B);
+    } else {
+      T.template solveInPlace<Eigen::OnTheRight>(B);
+    }
+  });
+}
+
+void CpuPipeline::trmm(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                       Eigen::MatrixXd &C, Side side, Triangle triangle,
+                       Operation op, Diagonal diagonal,
+                       double alpha) const {
+  Eigen::Index inner = (side == Side::Left) ? B.rows() : B.cols();
+  throw_if_not_triangular(A, inner, triangle, "trmm");
+  // Without noalias the product is safe when C is B
+  with_triangle(A, triangle, op, diagonal, [&](const auto &T) {
+    if (side == Side::Left) {
+      C = T * B;
+    } else {
+      C = B * T;
+    }
+  });
+  C *= alpha;
+}
+
+#ifdef EIGENCUDA_USE_LAPACK
+// Fortran LAPACK, the trailing arguments are the lengths of the strings
+extern "C" {
+void dsyevd_(const char *jobz, const char *uplo, const int *n, double *a,
+             const int *lda, double *w, double *work, const int *lwork,
+             int *iwork, const int *liwork, int *info, size_t jobz_length,
+             size_t uplo_length);
+void dsyevr_(const char *jobz, const char *range, const char *uplo,
+             const int *n, double *a, const int *lda, const double *vl,
+             const double *vu, const int *il, const int *iu,
+             const double *abstol, int *m, double *w, double *z,
+             const int *ldz, int *isuppz, double *work, const int *lwork,
+             int *iwork, const int *liwork, int *info, size_t jobz_length,
+             size_t range_length, size_t uplo_length);
+}
+#endif
+
+namespace {
+void throw_if_not_symmetric_range(const Eigen::MatrixXd &A, Eigen::Index first,
+                                  Eigen::Index count) {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("The eigensolver requires a square matrix");
+  }
+  if (first < 0 || count < 1 || first + count > A.rows()) {
+    throw std::runtime_error("Eigenpairs requested out of range");
+  }
+}
+}  // namespace
+
+void CpuPipeline::syevd(const Eigen::MatrixXd &A, Eigen::MatrixXd &eigenvalues,
+                        Eigen::MatrixXd &eigenvectors) const {
+#ifdef EIGENCUDA_USE_LAPACK
+  throw_if_not_symmetric_range(A, 0, A.rows());
+  int n = int(A.rows());
+  // The eigenvectors overwrite the input
+  eigenvectors = A;
+  eigenvalues.resize(n, 1);
+  char jobz = 'V';
+  char uplo = 'L';
+  int info = 0;
+  // Workspace query first
+  int lwork = -1;
+  int liwork = -1;
+  double work_size = 0.;
+  int iwork_size = 0;
+  dsyevd_(&jobz, &uplo, &n, eigenvectors.data(), &n, eigenvalues.data(),
+          &work_size, &lwork, &iwork_size, &liwork, &info, 1, 1);
+  lwork = int(work_size);
+  liwork = iwork_size;
+  std::vector<double> work(lwork);
+  std::vector<int> iwork(liwork);
+  dsyevd_(&jobz, &uplo, &n, eigenvectors.data(), &n, eigenvalues.data(),
+          work.data(), &lwork, iwork.data(), &liwork, &info, 1, 1);
+  if (info != 0) {
+    throw std::runtime_error("The eigensolver did not converge");
+  }
+#else
+  syevdx(A, 0, A.rows(), eigenvalues, eigenvectors);
+#endif
+}
+
+void CpuPipeline::syevdx(const Eigen::MatrixXd &A, Eigen::Index first,
+                         Eigen::Index count, Eigen::MatrixXd &eigenvalues,
+                         Eigen::MatrixXd &eigenvectors) const {
+  throw_if_not_symmetric_range(A, first, count);
+#ifdef EIGENCUDA_USE_LAPACK
+  // Relatively robust representations, only the requested range is computed
+  int n = int(A.rows());
+  Eigen::MatrixXd work_A = A;
+  eigenvalues.resize(n, 1);
+  eigenvectors.resize(n, count);
+  char jobz = 'V';
+  char range = 'I';
+  char uplo = 'L';
+  double bound = 0.;
+  double abstol = 0.;
+  // LAPACK counts the eigenvalues from 1
+  int il = int(first) + 1;
+  int iu = int(first + count);
+  int found = 0;
+  int ldz = std::max(n, 1);
+  std::vector<int> isuppz(2 * count);
+  int info = 0;
+  int lwork = -1;
+  int liwork = -1;
+  double work_size = 0.;
+  int iwork_size = 0;
+  dsyevr_(&jobz, &range, &uplo, &n, work_A.data(), &n, &bound, &bound, &il,
+          &iu, &abstol, &found, eigenvalues.data(), eigenvectors.data(), &ldz,
+          isuppz.data(), &work_size, &lwork, &iwork_size, &liwork, &info, 1,
+          1, 1);
+  lwork = int(work_size);
+  liwork = iwork_size;
+  std::vector<double> work(lwork);
+  std::vector<int> iwork(liwork);
+  dsyevr_(&jobz, &range, &uplo, &n, work_A.data(), &n, &bound, &bound, &il,
+          &iu, &abstol, &found, eigenvalues.data(), eigenvectors.data(), &ldz,
+          isuppz.data(), work.data(), &lwork, iwork.data(), &liwork, &info, 1,
+          1, 1);
+  if (info != 0 || found != count) {
+    throw std::runtime_error("The eigensolver did not converge");
+  }
+  eigenvalues.conservativeResize(count, 1);
+#else
+  // Eigen only reads the lower triangle, like cusolver. Its tridiagonal
+  // reduction is sequential and it always computes the whole spectrum
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(A);
+  if (solver.info() != Eigen::Success) {
+    throw std::runtime_error("The eigensolver did not converge");
+  }
+  eigenvalues = solver.eigenvalues().segment(first, count);
+  eigenvectors = solver.eigenvectors().middleCols(first, count);
+#endif
+}
+
+namespace {
+// Orthonormal basis of the span of the columns of Y
+void orthonormalize(Eigen::MatrixXd &Y) {
+  Eigen::HouseholderQR<Eigen::MatrixXd> qr(Y);
+  Y = qr.householderQ() * Eigen::MatrixXd::Identity(Y.rows(), Y.cols());
+}
+}  // namespace
+
+void CpuPipeline::randomized_svd(const Eigen::MatrixXd &A, Eigen::Index rank,
+                                 Eigen::MatrixXd &U, Eigen::MatrixXd &S,
+                                 Eigen::MatrixXd &V, Eigen::Index oversampling,
+                                 Eigen::Index power_iterations,
+                                 std::uint64_t seed) const {
+  Eigen::Index m = A.rows();
+  Eigen::Index n = A.cols();
+  if (rank < 1 || rank > std::min(m, n)) {
+    throw std::runtime_error("The rank of the randomized SVD is out of range");
+  }
+  if (oversampling < 0 || power_iterations < 0) {
+    throw std::runtime_error(
+        "Negative oversampling or power iterations in the randomized SVD");
+  }
+  Eigen::Index l = std::min(rank + oversampling, std::min(m, n));
+
+  Eigen::MatrixXd Z(n, l);
+  random(Z, Distribution::Normal, seed);
+  Eigen::MatrixXd Q = A * Z;
+  orthonormalize(Q);
+  for (Eigen::Index i = 0; i < power_iterations; i++) {
+    Z.noalias() = A.transpose() * Q;
+    orthonormalize(Z);
+    Q.noalias() = A * Z;
+    orthonormalize(Q);
+  }
+
+  // B^T = A^T * Q = W * S * X^T, hence A ~ (Q * X) * S * W^T
+  Z.noalias() = A.transpose() * Q;
+  Eigen::JacobiSVD<Eigen::MatrixXd> svd(Z, Eigen::ComputeThinU |
+                                               Eigen::ComputeThinV);
+  S = svd.singularValues().head(rank);
+  V = svd.matrixU().leftCols(rank);
+  U.noalias() = Q * svd.matrixV().leftCols(rank);
+}
+
+Eigen::LLT<Eigen::MatrixXd> CpuPipeline::potrf(
+    const Eigen::MatrixXd &A) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error(
+        "Cholesky factorization requires a square matrix");
+  }
+  Eigen::LLT<Eigen::MatrixXd> factor(A);
+  if (factor.info() != Eigen::Success) {
+    throw std::runtime_error("The matrix is not positive definite");
+  }
+  return factor;
+}
+
+void CpuPipeline::potrs(const Eigen::LLT<Eigen::MatrixXd> &factor,
+                        Eigen::MatrixXd &B) const {
+  if (B.rows() != factor.rows()) {
+    throw std::runtime_error("Shape mismatch in the right hand side");
+  }
+  factor.solveInPlace(B);
+}
+
+Eigen::PartialPivLU<Eigen::MatrixXd> CpuPipeline::getrf(
+    const Eigen::MatrixXd &A) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("LU factorization requires a square matrix");
+  }
+  Eigen::PartialPivLU<Eigen::MatrixXd> factor(A);
+  if (has_zero_pivot(factor)) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  return factor;
+}
+
+void CpuPipeline::getrs(const Eigen::PartialPivLU<Eigen::MatrixXd> &factor,
+                        Eigen::MatrixXd &B) const {
+  if (B.rows() != factor.rows()) {
+    throw std::runtime_error("Shape mismatch in the right hand side");
+  }
+  B = factor.solve(B);
+}
+
+std::vector<Eigen::LLT<Eigen::MatrixXd>> CpuPipeline::potrf_batched(
+    const Eigen::MatrixXd &A, Eigen::Index batch) const {
+  throw_if_not_side_by_side(A, batch, "Batched Cholesky factorization");
+  Eigen::Index n = A.rows();
+  std::vector<Eigen::LLT<Eigen::MatrixXd>> factors(batch);
+  Eigen::Index first_failed = batch;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min : first_failed)
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    factors[i].compute(A.middleCols(i * n, n));
+    if (factors[i].info() != Eigen::Success) {
+      first_failed = std::min(first_failed, i);
+    }
+  }
+  throw_if_batch_failed(first_failed, batch, "is not positive definite");
+  return factors;
+}
+
+void CpuPipeline::potrs_batched(
+    const std::vector<Eigen::LLT<Eigen::MatrixXd>> &factors,
+    Eigen::MatrixXd &B) const {
+  Eigen::Index batch = factors.size();
+  Eigen::Index n = batch > 0 ? factors.front().rows() : 0;
+  throw_if_cannot_solve(n, factors.size(), B);
+  Eigen::Index columns = B.cols() / batch;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    B.middleCols(i * columns, columns) =
+        factors[i].solve(B.middleCols(i * columns, columns));
+  }
+}
+
+std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> CpuPipeline::getrf_batched(
+    const Eigen::MatrixXd &A, Eigen::Index batch) const {
+  throw_if_not_side_by_side(A, batch, "Batched LU factorization");
+  Eigen::Index n = A.rows();
+  std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> factors(batch);
+  Eigen::Index first_failed = batch;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min : first_failed)
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    factors[i].compute(A.middleCols(i * n, n));
+    if (has_zero_pivot(factors[i])) {
+      first_failed = std::min(first_failed, i);
+    }
+  }
+  throw_if_batch_failed(first_failed, batch, "is singular");
+  return factors;
+}
+
+void CpuPipeline::getrs_batched(
+    const std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> &factors,
+    Eigen::MatrixXd &B) const {
+  Eigen::Index batch = factors.size();
+  Eigen::Index n = batch > 0 ? factors.front().rows() : 0;
+  throw_if_cannot_solve(n, factors.size(), B);
+  Eigen::Index columns = B.cols() / batch;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (Eigen::Index i = 0; i < batch; i++) {
+    B.middleCols(i * columns, columns) =
+        factors[i].solve(B.middleCols(i * columns, columns));
+  }
+}
+
+void CpuPipeline::inverse_batched(const Eigen::MatrixXd &A,
+                                  Eigen::MatrixXd &inverse,
+                                  Eigen::Index batch) const {
+  throw_if_not_side_by_side(A, batch, "Batched inversion");
+  Eigen::Index n = A.rows();
+  inverse.resize(n, A.cols());
+  Eigen::Index first_singular = batch;
+  const double *data = A.data();
+  double *result = inverse.data();
+  switch (n) {
+    case 8:
+      first_singular = inverse_batch<8>(data, result, n, batch);
+      break;
+    case 16:
+      first_singular = inverse_batch<16>(data, result, n, batch);
+      break;
+    case 24:
+      first_singular = inverse_batch<24>(data, result, n, batch);
+      break;
+    case 32:
+      first_singular = inverse_batch<32>(data, result, n, batch);
+      break;
+    case 40:
+      first_singular = inverse_batch<40>(data, result, n, batch);
+      break;
+    case 48:
+      first_singular = inverse_batch<48>(data, result, n, batch);
+      break;
+    case 56:
+      first_singular = inverse_batch<56>(data, result, n, batch);
+      break;
+    case 64:
+      first_singular = inverse_batch<64>(data, result, n, batch);
+      break;
+    default:
+      first_singular = inverse_batch<Eigen::Dynamic>(data, result, n, batch);
+  }
+  throw_if_batch_failed(first_singular, batch, "is singular");
+}
+
+}  // namespace eigencuda
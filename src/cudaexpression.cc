@@ -0,0 +1,132 @@
+#include "cudaexpression.hpp"
+
+namespace eigencuda {
+
+namespace {
+// Whether the elements of A share memory with the `size` elements from D,
+// views of the same buffer may start at different offsets
+bool overlaps(const CudaMatrix &A, const double *D, Index size) {
+  return A.data() < D + size && D < A.data() + A.size();
+}
+
+// cublas cannot write into memory that it is reading with a different
+// layout, i.e. a factor of a product, a transposed summand or a summand that
+// does not start where D does
+bool reads_with_other_layout(const Term &term, const CudaMatrix &D,
+                             Index size) {
+  if (term.is_product()) {
+    return overlaps(*term.A, D.data(), size) ||
+           overlaps(*term.B, D.data(), size);
+  }
+  bool same_layout =
+      term.op_A == Operation::None && term.A->data() == D.data();
+  return !same_layout && overlaps(*term.A, D.data(), size);
+}
+
+bool is_accumulator(const Term &term, const CudaMatrix &D) {
+  return !term.is_product() && term.op_A == Operation::None &&
+         term.A->data() == D.data();
+}
+}  // namespace
+
+Temporaries::Temporaries(const CudaPipeline &pipeline)
+    : _pipeline{pipeline}, _scope{pipeline.workspace_scope()} {}
+
+CudaMatrix &Temporaries::matrix(Index nrows, Index ncols) {
+  _matrices.push_back(_pipeline.scratch(nrows, ncols));
+  return _matrices.back();
+}
+
+void evaluate(const CudaPipeline &pipeline, const std::vector<Term> &terms,
+              CudaMatrix &D) {
+  if (terms.empty()) {
+    throw std::runtime_error("Cannot evaluate an empty expression");
+  }
+  Index rows = terms.front().rows();
+  Index cols = terms.front().cols();
+  for (const Term &term : terms) {
+    if (term.rows() != rows || term.cols() != cols) {
+      throw std::runtime_error("Shape mismatch in expression");
+    }
+    if (term.is_product()) {
+      Index inner_A = (term.op_A == Operation::None) ? term.A->cols()
+                                                  : term.A->rows();
+      Index inner_B = (term.op_B == Operation::None) ? term.B->rows()
+                                                  : term.B->cols();
+      if (inner_A != inner_B) {
+        throw std::runtime_error("Shape mismatch in expression product");
+      }
+    }
+  }
+
+  for (const Term &term : terms) {
+    if (reads_with_other_layout(term, D, rows * cols)) {
+      // Only case requiring a temporary
+      Temporaries temporaries{pipeline};
+      CudaMatrix &result = temporaries.matrix(rows, cols);
+      evaluate(pipeline, terms, result);
+      pipeline.copy(result, D);
+      return;
+    }
+  }
+
+  // The content of D is scaled by beta, which is folded in the next call
+  double beta = 0.;
+  bool initialized = false;
+  std::vector<const Term *> matrices;
+  std::vector<const Term *> products;
+  for (const Term &term : terms) {
+    if (is_accumulator(term, D)) {
+      beta += term.alpha;
+      initialized = true;
+    } else if (term.is_product()) {
+      products.push_back(&term);
+    } else {
+      matrices.push_back(&term);
+    }
+  }
+  if (!initialized) {
+    D.resize(rows, cols);
+  }
+
+  // Add the summands, two at a time while D has no content yet
+  size_t i = 0;
+  while (i < matrices.size()) {
+    const Term &M = *matrices[i];
+    if (initialized) {
+      pipeline.geam(D, *M.A, D, beta, M.alpha, Operation::None, M.op_A);
+      i++;
+    } else if (i + 1 < matrices.size()) {
+      const Term &N = *matrices[i + 1];
+      pipeline.geam(*M.A, *N.A, D, M.alpha, N.alpha, M.op_A, N.op_A);
+      i += 2;
+    } else if (M.op_A == Operation::None &&
+               (!products.empty() || M.alpha == 1.)) {
+      // The scalar is folded into the beta of the first gemm
+      pipeline.copy(*M.A, D);
+      beta = M.alpha;
+      initialized = true;
+      i++;
+      continue;
+    } else {
+      pipeline.geam(*M.A, *M.A, D, M.alpha, 0., M.op_A, M.op_A);
+      i++;
+    }
+    beta = 1.;
+    initialized = true;
+  }
+
+  for (const Term *P : products) {
+    pipeline.gemm(*P->A, *P->B, D, P->alpha, initialized ? beta : 0., P->op_A,
+                  P->op_B);
+    beta = 1.;
+    initialized = true;
+  }
+
+  // Only the content of D was referenced, with a scalar
+  if (beta != 1.) {
+    pipeline.geam(D, D, D, beta, 0.);
+  }
+}
+
+}  // namespace eigencuda
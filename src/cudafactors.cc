@@ -0,0 +1,19 @@
+#include "cudafactors.hpp"
+
+namespace eigencuda {
+
+LUFactor::LUFactor(CudaMatrix &&factor) : _factor{std::move(factor)} {
+  int *pivots;
+  checkCuda(cudaMalloc(&pivots, _factor.rows() * sizeof(int)));
+  _pivots.reset(pivots);
+}
+
+BatchedLUFactor::BatchedLUFactor(CudaTensor &&factors)
+    : _factors{std::move(factors)} {
+  int *pivots;
+  checkCuda(cudaMalloc(&pivots,
+                       _factors.rows() * _factors.depth() * sizeof(int)));
+  _pivots.reset(pivots);
+}
+
+}  // namespace eigencuda
@@ -0,0 +1,107 @@
+#ifndef CUDA_KERNELS_H_
+#define CUDA_KERNELS_H_
+
+#include "operations.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cuda_runtime.h>
+
+/*
+ * \brief Launchers of the custom kernels of the library
+ *
+ * The kernels are compiled by nvcc, these plain C++ declarations let the
+ * rest of the library call them. Every launcher enqueues the work in `stream`
+ * and returns the launch status.
+ */
+
+namespace eigencuda {
+namespace kernels {
+
+using Index = std::ptrdiff_t;
+
+// C = A .* B
+cudaError_t hadamard_product(const double *A, const double *B, double *C,
+                             Index size, cudaStream_t stream);
+
+// C = A ./ B
+cudaError_t hadamard_division(const double *A, const double *B, double *C,
+                              Index size, cudaStream_t stream);
+
+// A = f(A)
+cudaError_t apply(double *A, Index size, UnaryFunction function,
+                  cudaStream_t stream);
+
+// Number of doubles of scratch memory used by the reductions
+Index reduction_buffer_size();
+
+// result = sum_i A[i * stride] for i < size, result is a device pointer
+cudaError_t sum(const double *A, Index size, Index stride, double *buffer,
+                double *result, cudaStream_t stream);
+
+// result = max_i |A[i]|, result is a device pointer
+cudaError_t max_abs(const double *A, Index size, double *buffer,
+                    double *result, cudaStream_t stream);
+
+// Euclidean norm of the columns of a column-major matrix into norms
+cudaError_t column_norms(const double *A, Index rows, Index cols,
+                         double *norms, cudaStream_t stream);
+
+// Copy the stored triangle of the n x n matrix C into the other one
+cudaError_t symmetrize(double *C, Index n, bool lower, cudaStream_t stream);
+
+// Copy a triangle of C, diagonal included, into n * (n + 1) / 2 doubles
+// using the column-major packed storage of LAPACK
+cudaError_t pack_triangle(const double *C, Index n, bool lower,
+                          double *packed, cudaStream_t stream);
+
+// B = A with its dimensions reordered, output dimension d is the input one
+// permutation[d]. The first dimension runs fastest, rank is at most 8
+cudaError_t permute(const double *A, const Index *dims, const int *permutation,
+                    int rank, double *B, cudaStream_t stream);
+
+// Fill A with element i of the Philox sequence (seed, subsequence) at A[i]
+cudaError_t random(double *A, Index size, Distribution distribution,
+                   std::uint64_t seed, std::uint64_t subsequence,
+                   cudaStream_t stream);
+
+// C_i = A_i * B_i for `batch` n x n matrices stored one after the other, with
+// a kernel specialized for every n up to max_small_size
+cudaError_t small_gemm(const double *A, const double *B, double *C, int n,
+                       Index batch, cudaStream_t stream);
+
+// pointers[i] = first + i * stride, the arrays of matrices of the batched
+// cublas and cusolver routines, filled without a host transfer
+cudaError_t batch_pointers(double *first, Index stride, Index batch,
+                           double **pointers, cudaStream_t stream);
+
+// R = AX - X * diag(theta), the residuals of the Ritz pairs of the columns
+cudaError_t ritz_residuals(const double *X, const double *AX,
+                           const double *theta, Index rows, Index cols,
+                           double *R, cudaStream_t stream);
+
+// T_ij = R_ij / (theta_j - diagonal_i), the diagonal preconditioner of the
+// Davidson corrections. T may be R
+cudaError_t davidson_correction(const double *R, const double *diagonal,
+                                const double *theta, Index rows, Index cols,
+                                double *T, cudaStream_t stream);
+
+// Scales of the Ozaki splitting of a column major matrix, the power of two
+// above the largest magnitude of every row (by_rows) or column
+cudaError_t split_scales(const double *A, Index rows, Index cols,
+                         bool by_rows, double *scales, cudaStream_t stream);
+
+// Cut A divided by its scales into `slices` single precision matrices of
+// `width` bits, stored one after the other in output
+cudaError_t split_slices(const double *A, Index rows, Index cols,
+                         const double *scales, bool by_rows, int width,
+                         int slices, float *output, cudaStream_t stream);
+
+// C (+)= diag(row_scales) * P * diag(col_scales), overwriting C if requested
+cudaError_t accumulate_split(const float *P, const double *row_scales,
+                             const double *col_scales, Index rows, Index cols,
+                             double *C, bool overwrite, cudaStream_t stream);
+
+}  // namespace kernels
+}  // namespace eigencuda
+
+#endif  // CUDA_KERNELS_H_
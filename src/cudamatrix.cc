@@ -20,7 +20,8 @@ Index count_available_gpus() {
 CudaMatrix::CudaMatrix(const Eigen::MatrixXd &matrix,
                        const cudaStream_t &stream)
     : _rows{static_cast<Index>(matrix.rows())},
-      _cols{static_cast<Index>(matrix.cols())} {
+      _cols{static_cast<Index>(matrix.cols())},
+      _capacity{static_cast<Index>(matrix.size())} {
   _data = alloc_matrix_in_gpu(size_matrix());
   _stream = stream;
   cudaError_t err = cudaMemcpyAsync(_data.get(), matrix.data(), size_matrix(),
@@ -30,13 +31,74 @@ CudaMatrix::CudaMatrix(const Eigen::MatrixXd &matrix,
   }
 }
 
-CudaMatrix::CudaMatrix(Index nrows, Index ncols, const cudaStream_t &stream)
-    : _rows{static_cast<Index>(nrows)}, _cols{static_cast<Index>(ncols)} {
+CudaMatrix::CudaMatrix(const RowMajorMatrixXd &matrix,
+                       const cudaStream_t &stream)
+    : CudaMatrix{static_cast<Index>(matrix.rows()),
+                 static_cast<Index>(matrix.cols()), stream, MemoryKind::Device,
+                 StorageOrder::RowMajor} {
+  cudaError_t err = cudaMemcpyAsync(_data.get(), matrix.data(), size_matrix(),
+                                    cudaMemcpyHostToDevice, stream);
+  if (err != 0) {
+    throw std::runtime_error("Error copy arrays to device");
+  }
+}
+
+CudaMatrix::CudaMatrix(Index nrows, Index ncols, const cudaStream_t &stream,
+                       MemoryKind kind, StorageOrder order)
+    : _kind{kind},
+      _order{order},
+      _rows{static_cast<Index>(nrows)},
+      _cols{static_cast<Index>(ncols)},
+      _capacity{nrows * ncols} {
   _data = alloc_matrix_in_gpu(size_matrix());
   _stream = stream;
 }
 
+CudaMatrix::CudaMatrix(double *data, Index nrows, Index ncols,
+                       const cudaStream_t &stream, MemoryKind kind)
+    : _data{data, [](double *) {}},
+      _kind{kind},
+      _rows{nrows},
+      _cols{ncols},
+      _capacity{nrows * ncols},
+      _owns_memory{false} {
+  _stream = stream;
+}
+
+CudaMatrix::CudaMatrix(CudaMatrix &&other) noexcept
+    : _data{std::move(other._data)},
+      _stream{other._stream},
+      _kind{other._kind},
+      _order{other._order},
+      _rows{other._rows},
+      _cols{other._cols},
+      _capacity{other._capacity},
+      _owns_memory{other._owns_memory} {
+  other._rows = other._cols = other._capacity = 0;
+  other._owns_memory = true;
+}
+
+CudaMatrix &CudaMatrix::operator=(CudaMatrix &&other) noexcept {
+  if (this != &other) {
+    _data = std::move(other._data);
+    _stream = other._stream;
+    _kind = other._kind;
+    _order = other._order;
+    _rows = other._rows;
+    _cols = other._cols;
+    _capacity = other._capacity;
+    _owns_memory = other._owns_memory;
+    other._rows = other._cols = other._capacity = 0;
+    other._owns_memory = true;
+  }
+  return *this;
+}
+
 CudaMatrix::operator Eigen::MatrixXd() const {
+  if (_order == StorageOrder::RowMajor) {
+    RowMajorMatrixXd result = *this;
+    return result;
+  }
   Eigen::MatrixXd result = Eigen::MatrixXd::Zero(this->rows(), this->cols());
   checkCuda(cudaMemcpyAsync(result.data(), this->data(), this->size_matrix(),
                             cudaMemcpyDeviceToHost, this->_stream));
@@ -44,17 +106,119 @@ CudaMatrix::operator Eigen::MatrixXd() const {
   return result;
 }
 
+CudaMatrix::operator RowMajorMatrixXd() const {
+  if (_order == StorageOrder::ColMajor) {
+    Eigen::MatrixXd result = *this;
+    return result;
+  }
+  RowMajorMatrixXd result(this->rows(), this->cols());
+  checkCuda(cudaMemcpyAsync(result.data(), this->data(), this->size_matrix(),
+                            cudaMemcpyDeviceToHost, this->_stream));
+  checkCuda(cudaStreamSynchronize(this->_stream));
+  return result;
+}
+
 void CudaMatrix::copy_to_gpu(const Eigen::MatrixXd &A) {
+  this->resize(static_cast<Index>(A.rows()), static_cast<Index>(A.cols()),
+               StorageOrder::ColMajor);
   size_t size_A = static_cast<Index>(A.size()) * sizeof(double);
   checkCuda(cudaMemcpyAsync(this->data(), A.data(), size_A,
                             cudaMemcpyHostToDevice, _stream));
 }
 
+void CudaMatrix::copy_to_gpu(const RowMajorMatrixXd &A) {
+  this->resize(static_cast<Index>(A.rows()), static_cast<Index>(A.cols()),
+               StorageOrder::RowMajor);
+  size_t size_A = static_cast<Index>(A.size()) * sizeof(double);
+  checkCuda(cudaMemcpyAsync(this->data(), A.data(), size_A,
+                            cudaMemcpyHostToDevice, _stream));
+}
+
+Eigen::Map<Eigen::MatrixXd> CudaMatrix::host_view() const {
+  if (_kind != MemoryKind::Managed) {
+    throw std::runtime_error("Only managed matrices are accessible from host");
+  }
+  if (_order != StorageOrder::ColMajor) {
+    throw std::runtime_error("The host view requires column major storage");
+  }
+  return Eigen::Map<Eigen::MatrixXd>(this->data(), _rows, _cols);
+}
+
+void CudaMatrix::throw_if_view(const std::string &operation) const {
+  if (!_owns_memory) {
+    std::ostringstream oss;
+    oss << "Cannot " << operation << " a view of " << _capacity
+        << " elements, its memory belongs to another matrix\n";
+    throw std::runtime_error(oss.str());
+  }
+}
+
+void CudaMatrix::resize(Index nrows, Index ncols) {
+  if (nrows * ncols > _capacity) {
+    // A new buffer would detach the view from the memory it refers to
+    throw_if_view("grow");
+    // Free the old buffer before requesting the new one
+    _data.reset();
+    _data = alloc_matrix_in_gpu(nrows * ncols * sizeof(double));
+    _capacity = nrows * ncols;
+  }
+  _rows = nrows;
+  _cols = ncols;
+}
+
+void CudaMatrix::resize(Index nrows, Index ncols, StorageOrder order) {
+  resize(nrows, ncols);
+  _order = order;
+}
+
+void CudaMatrix::reshape(Index nrows, Index ncols) {
+  if (nrows * ncols != this->size()) {
+    std::ostringstream oss;
+    oss << "Cannot reshape a matrix of size " << this->size() << " into ("
+        << nrows << ", " << ncols << ")\n";
+    throw std::runtime_error(oss.str());
+  }
+  _rows = nrows;
+  _cols = ncols;
+}
+
+CudaMatrix CudaMatrix::middle_cols(Index first, Index count) const {
+  if (_order != StorageOrder::ColMajor) {
+    throw std::runtime_error("Column views require a column major matrix");
+  }
+  if (first < 0 || count < 0 || first + count > _cols) {
+    std::ostringstream oss;
+    oss << "Columns [" << first << ", " << first + count
+        << ") are out of a matrix with " << _cols << " columns\n";
+    throw std::runtime_error(oss.str());
+  }
+  return CudaMatrix{data() + first * _rows, _rows, count, _stream, _kind};
+}
+
+void CudaMatrix::shrink_to_fit() {
+  throw_if_view("shrink");
+  if (_capacity == this->size()) {
+    return;
+  }
+  Unique_ptr_to_GPU_data data = alloc_matrix_in_gpu(size_matrix());
+  checkCuda(cudaMemcpyAsync(data.get(), _data.get(), size_matrix(),
+                            cudaMemcpyDeviceToDevice, _stream));
+  // The old buffer may only be freed once the copy is done
+  checkCuda(cudaStreamSynchronize(_stream));
+  _data = std::move(data);
+  _capacity = this->size();
+}
+
 CudaMatrix::Unique_ptr_to_GPU_data CudaMatrix::alloc_matrix_in_gpu(
     size_t size_arr) const {
   double *dmatrix;
-  throw_if_not_enough_memory_in_gpu(size_arr);
-  checkCuda(cudaMalloc(&dmatrix, size_arr));
+  if (_kind == MemoryKind::Managed) {
+    // Managed memory can oversubscribe the device
+    checkCuda(cudaMallocManaged(&dmatrix, size_arr));
+  } else {
+    throw_if_not_enough_memory_in_gpu(size_arr);
+    checkCuda(cudaMalloc(&dmatrix, size_arr));
+  }
   Unique_ptr_to_GPU_data dev_ptr(dmatrix,
                                  [](double *x) { checkCuda(cudaFree(x)); });
   return dev_ptr;
@@ -1,34 +1,1307 @@
 
 #include "cudapipeline.hpp"
+#include "cudakernels.hpp"
+#include "split.hpp"
 
 namespace eigencuda {
   CudaPipeline::~CudaPipeline() {
 
-  // destroy handle
+  // destroy handles
   cublasDestroy(_handle);
+  cusolverDnDestroy(_solver_handle);
+  cusparseDestroy(_sparse_handle);
   // destroy stream
   cudaStreamDestroy(_stream);
 }
 
+namespace {
+cublasOperation_t cublas_operation(Operation op) {
+  return (op == Operation::None) ? CUBLAS_OP_N : CUBLAS_OP_T;
+}
+
+cublasOperation_t transposed(cublasOperation_t op) {
+  return (op == CUBLAS_OP_N) ? CUBLAS_OP_T : CUBLAS_OP_N;
+}
+
+bool is_row_major(const CudaMatrix &A) {
+  return A.storage_order() == StorageOrder::RowMajor;
+}
+
+// The buffer of a row major matrix holds its transpose in column major order
+cublasOperation_t blas_operation(const CudaMatrix &A, Operation op) {
+  cublasOperation_t blas_op = cublas_operation(op);
+  return is_row_major(A) ? transposed(blas_op) : blas_op;
+}
+
+void throw_if_row_major(const CudaMatrix &A, const std::string &operation) {
+  if (is_row_major(A)) {
+    throw std::runtime_error(operation + " requires column major storage");
+  }
+}
+}  // namespace
+
 /*
  * Call the gemm function from cublas, resulting in the multiplication of the
  * two matrices
  */
 void CudaPipeline::gemm(const CudaMatrix &A, const CudaMatrix &B,
                         CudaMatrix &C) const {
+  gemm(A, B, C, 1., 0.);
+}
 
-  // Scalar constanst for calling blas
+void CudaPipeline::gemm(const CudaMatrix &A, const CudaMatrix &B,
+                        CudaMatrix &C, double alpha, double beta,
+                        Operation op_A, Operation op_B) const {
+  Index rows_A = (op_A == Operation::None) ? A.rows() : A.cols();
+  Index cols_A = (op_A == Operation::None) ? A.cols() : A.rows();
+  Index rows_B = (op_B == Operation::None) ? B.rows() : B.cols();
+  Index cols_B = (op_B == Operation::None) ? B.cols() : B.rows();
+
+  if ((cols_A != rows_B)) {
+    throw std::runtime_error("Shape mismatch in Cublas gemm");
+  }
+  if (beta == 0.) {
+    C.resize(rows_A, cols_B);
+  } else if (C.rows() != rows_A || C.cols() != cols_B) {
+    throw std::runtime_error("Shape mismatch in Cublas gemm accumulation");
+  }
+  cublasOperation_t blas_A = blas_operation(A, op_A);
+  cublasOperation_t blas_B = blas_operation(B, op_B);
+  int lda = int(A.leading_dimension());
+  int ldb = int(B.leading_dimension());
+  int ldc = int(C.leading_dimension());
+  if (is_row_major(C)) {
+    // C^T = op(B)^T * op(A)^T
+    cublasDgemm(_handle, transposed(blas_B), transposed(blas_A), int(cols_B),
+                int(rows_A), int(cols_A), &alpha, B.data(), ldb, A.data(), lda,
+                &beta, C.data(), ldc);
+  } else {
+    cublasDgemm(_handle, blas_A, blas_B, int(rows_A), int(cols_B), int(cols_A),
+                &alpha, A.data(), lda, B.data(), ldb, &beta, C.data(), ldc);
+  }
+}
+
+void CudaPipeline::gemm(const CudaTensor &T, const CudaMatrix &B,
+                        CudaTensor &R) const {
+  throw_if_row_major(B, "The tensor gemm");
+  if (T.cols() != B.rows()) {
+    throw std::runtime_error("Shape mismatch in Cublas tensor gemm");
+  }
+  R.resize(T.rows(), B.cols(), T.depth());
   double alpha = 1.;
   double beta = 0.;
-  const double *palpha = &alpha;
-  const double *pbeta = &beta;
+  // Every matrix of T is multiplied by the same B, hence its zero stride
+  cublasDgemmStridedBatched(
+      _handle, CUBLAS_OP_N, CUBLAS_OP_N, int(T.rows()), int(B.cols()),
+      int(T.cols()), &alpha, T.data(), int(std::max<Index>(T.rows(), 1)),
+      T.rows() * T.cols(), B.data(), int(std::max<Index>(B.rows(), 1)), 0,
+      &beta, R.data(), int(std::max<Index>(R.rows(), 1)),
+      R.rows() * R.cols(), int(T.depth()));
+}
 
-  if ((A.cols() != B.rows())) {
-    throw std::runtime_error("Shape mismatch in Cublas gemm");
+void CudaPipeline::gemm_batched(const CudaTensor &A, const CudaTensor &B,
+                                CudaTensor &C) const {
+  if (A.cols() != B.rows() || A.depth() != B.depth()) {
+    throw std::runtime_error("Shape mismatch in batched gemm");
+  }
+  C.resize(A.rows(), B.cols(), A.depth());
+  Index n = A.rows();
+  bool small_square = A.cols() == n && B.cols() == n && n <= max_small_size;
+  if (small_square && n > 0) {
+    checkCuda(kernels::small_gemm(A.data(), B.data(), C.data(), int(n),
+                                  A.depth(), _stream));
+    return;
+  }
+  double alpha = 1.;
+  double beta = 0.;
+  cublasDgemmStridedBatched(
+      _handle, CUBLAS_OP_N, CUBLAS_OP_N, int(A.rows()), int(B.cols()),
+      int(A.cols()), &alpha, A.data(), int(std::max<Index>(A.rows(), 1)),
+      A.rows() * A.cols(), B.data(), int(std::max<Index>(B.rows(), 1)),
+      B.rows() * B.cols(), &beta, C.data(), int(std::max<Index>(C.rows(), 1)),
+      C.rows() * C.cols(), int(A.depth()));
+}
+
+void CudaPipeline::gemm_split(const CudaMatrix &A, const CudaMatrix &B,
+                              CudaMatrix &C, int bits,
+                              SplitArithmetic arithmetic) const {
+  throw_if_row_major(A, "The split gemm");
+  throw_if_row_major(B, "The split gemm");
+  if (A.cols() != B.rows()) {
+    throw std::runtime_error("Shape mismatch in split gemm");
+  }
+  if (bits < 1 || bits > 53) {
+    throw std::runtime_error("The split gemm accuracy must be 1 to 53 bits");
+  }
+  Index m = A.rows();
+  Index k = A.cols();
+  Index n = B.cols();
+  bool tensor_cores = arithmetic == SplitArithmetic::TensorFloat32;
+  int width = split::slice_width(
+      k, tensor_cores ? split::tf32_bits : split::float_bits);
+  if (width < 1) {
+    throw std::runtime_error("The inner dimension is too large to split");
+  }
+  int slices = split::number_of_slices(bits, k, width);
+  C.resize(m, n, StorageOrder::ColMajor);
+  if (C.size() == 0) {
+    return;
+  }
+
+  auto scope = workspace_scope();
+  CudaMatrix scales = scratch(m + n, 1);
+  // The single precision slices and products are kept in a double buffer
+  Index floats = slices * (m * k + k * n) + m * n;
+  CudaMatrix buffer = scratch((floats + 1) / 2, 1);
+  float *slices_A = reinterpret_cast<float *>(buffer.data());
+  float *slices_B = slices_A + slices * m * k;
+  float *product = slices_B + slices * k * n;
+  double *row_scales = scales.data();
+  double *col_scales = scales.data() + m;
+  checkCuda(kernels::split_scales(A.data(), m, k, true, row_scales, _stream));
+  checkCuda(kernels::split_scales(B.data(), k, n, false, col_scales, _stream));
+  checkCuda(kernels::split_slices(A.data(), m, k, row_scales, true, width,
+                                  slices, slices_A, _stream));
+  checkCuda(kernels::split_slices(B.data(), k, n, col_scales, false, width,
+                                  slices, slices_B, _stream));
+
+  float one = 1.f;
+  float zero = 0.f;
+  int lda = int(std::max<Index>(m, 1));
+  int ldb = int(std::max<Index>(k, 1));
+  bool first = true;
+  // Products of slices i of A and j of B with i + j < slices, the least
+  // significant ones first
+  for (int level = slices - 1; level >= 0; level--) {
+    for (int i = 0; i <= level; i++) {
+      const float *slice_A = slices_A + i * m * k;
+      const float *slice_B = slices_B + (level - i) * k * n;
+      if (tensor_cores) {
+        cublasGemmEx(_handle, CUBLAS_OP_N, CUBLAS_OP_N, int(m), int(n), int(k),
+                     &one, slice_A, CUDA_R_32F, lda, slice_B, CUDA_R_32F, ldb,
+                     &zero, product, CUDA_R_32F, int(m),
+                     CUBLAS_COMPUTE_32F_FAST_TF32,
+                     CUBLAS_GEMM_DEFAULT_TENSOR_OP);
+      } else {
+        cublasSgemm(_handle, CUBLAS_OP_N, CUBLAS_OP_N, int(m), int(n), int(k),
+                    &one, slice_A, lda, slice_B, ldb, &zero, product, int(m));
+      }
+      checkCuda(kernels::accumulate_split(product, row_scales, col_scales, m,
+                                          n, C.data(), first, _stream));
+      first = false;
+    }
+  }
+}
+
+void CudaPipeline::gemv(const CudaMatrix &A, const CudaVector &x,
+                        CudaVector &y, double alpha, double beta,
+                        Operation op) const {
+  Index rows_A = (op == Operation::None) ? A.rows() : A.cols();
+  Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != x.size()) {
+    throw std::runtime_error("Shape mismatch in Cublas gemv");
+  }
+  if (beta == 0.) {
+    y.resize(rows_A, 1);
+  } else if (y.size() != rows_A) {
+    throw std::runtime_error("Shape mismatch in Cublas gemv accumulation");
+  }
+  // Shape of the column major buffer of A
+  Index stored_rows = A.leading_dimension();
+  Index stored_cols = is_row_major(A) ? A.rows() : A.cols();
+  cublasDgemv(_handle, blas_operation(A, op), int(stored_rows),
+              int(stored_cols), &alpha, A.data(), int(stored_rows), x.data(),
+              1, &beta, y.data(), 1);
+}
+
+void CudaPipeline::gemv_batched(const CudaMatrix &A, const CudaMatrix &X,
+                                CudaMatrix &Y, Operation op) const {
+  gemm(A, X, Y, 1., 0., op, Operation::None);
+}
+
+void *CudaPipeline::sparse_buffer(size_t bytes) const {
+  Index size =
+      static_cast<Index>((bytes + sizeof(double) - 1) / sizeof(double));
+  if (!_sparse_buffer || _sparse_buffer->capacity() < size) {
+    // Freeing the previous buffer waits for the products still using it
+    _sparse_buffer =
+        std::unique_ptr<CudaMatrix>(new CudaMatrix(size, 1, _stream));
+  }
+  return _sparse_buffer->data();
+}
+
+namespace {
+cusparseOperation_t sparse_operation(Operation op) {
+  return (op == Operation::None) ? CUSPARSE_OPERATION_NON_TRANSPOSE
+                                 : CUSPARSE_OPERATION_TRANSPOSE;
+}
+
+cusparseOrder_t dense_order(const CudaMatrix &A) {
+  return is_row_major(A) ? CUSPARSE_ORDER_ROW : CUSPARSE_ORDER_COL;
+}
+
+// The default algorithms may split the rows among threads and accumulate with
+// atomics, these ones always sum the nonzeros of a row in the same order. They
+// only hold for the non-transposed products
+cusparseSpMMAlg_t spmm_algorithm(bool deterministic) {
+  return deterministic ? CUSPARSE_SPMM_CSR_ALG1 : CUSPARSE_SPMM_ALG_DEFAULT;
+}
+
+cusparseSpMVAlg_t spmv_algorithm(bool deterministic) {
+  return deterministic ? CUSPARSE_SPMV_CSR_ALG2 : CUSPARSE_SPMV_ALG_DEFAULT;
+}
+}  // namespace
+
+void CudaPipeline::spmm(const CudaSparseMatrix &A, const CudaMatrix &B,
+                        CudaMatrix &C, double alpha, double beta,
+                        Operation op) const {
+  // The transposed products have no deterministic algorithm
+  if (_deterministic && op == Operation::Transpose) {
+    spmm(A.transpose(_sparse_handle), B, C, alpha, beta, Operation::None);
+    return;
+  }
+  Index rows_A = (op == Operation::None) ? A.rows() : A.cols();
+  Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != B.rows()) {
+    throw std::runtime_error("Shape mismatch in Cusparse spmm");
+  }
+  if (beta == 0.) {
+    C.resize(rows_A, B.cols());
+  } else if (C.rows() != rows_A || C.cols() != B.cols()) {
+    throw std::runtime_error("Shape mismatch in Cusparse spmm accumulation");
+  }
+  cusparseDnMatDescr_t descr_B, descr_C;
+  cusparseCreateDnMat(&descr_B, B.rows(), B.cols(), B.leading_dimension(),
+                      B.data(), CUDA_R_64F, dense_order(B));
+  cusparseCreateDnMat(&descr_C, C.rows(), C.cols(), C.leading_dimension(),
+                      C.data(), CUDA_R_64F, dense_order(C));
+  size_t bytes = 0;
+  cusparseSpMM_bufferSize(_sparse_handle, sparse_operation(op),
+                          CUSPARSE_OPERATION_NON_TRANSPOSE, &alpha,
+                          A.descriptor(), descr_B, &beta, descr_C, CUDA_R_64F,
+                          spmm_algorithm(_deterministic), &bytes);
+  cusparseSpMM(_sparse_handle, sparse_operation(op),
+               CUSPARSE_OPERATION_NON_TRANSPOSE, &alpha, A.descriptor(),
+               descr_B, &beta, descr_C, CUDA_R_64F,
+               spmm_algorithm(_deterministic), sparse_buffer(bytes));
+  cusparseDestroyDnMat(descr_B);
+  cusparseDestroyDnMat(descr_C);
+}
+
+void CudaPipeline::spmv(const CudaSparseMatrix &A, const CudaVector &x,
+                        CudaVector &y, double alpha, double beta,
+                        Operation op) const {
+  // The transposed products have no deterministic algorithm
+  if (_deterministic && op == Operation::Transpose) {
+    spmv(A.transpose(_sparse_handle), x, y, alpha, beta, Operation::None);
+    return;
+  }
+  Index rows_A = (op == Operation::None) ? A.rows() : A.cols();
+  Index cols_A = (op == Operation::None) ? A.cols() : A.rows();
+  if (cols_A != x.size()) {
+    throw std::runtime_error("Shape mismatch in Cusparse spmv");
+  }
+  if (beta == 0.) {
+    y.resize(rows_A, 1);
+  } else if (y.size() != rows_A) {
+    throw std::runtime_error("Shape mismatch in Cusparse spmv accumulation");
+  }
+  cusparseDnVecDescr_t descr_x, descr_y;
+  cusparseCreateDnVec(&descr_x, x.size(), x.data(), CUDA_R_64F);
+  cusparseCreateDnVec(&descr_y, y.size(), y.data(), CUDA_R_64F);
+  size_t bytes = 0;
+  cusparseSpMV_bufferSize(_sparse_handle, sparse_operation(op), &alpha,
+                          A.descriptor(), descr_x, &beta, descr_y, CUDA_R_64F,
+                          spmv_algorithm(_deterministic), &bytes);
+  cusparseSpMV(_sparse_handle, sparse_operation(op), &alpha, A.descriptor(),
+               descr_x, &beta, descr_y, CUDA_R_64F,
+               spmv_algorithm(_deterministic), sparse_buffer(bytes));
+  cusparseDestroyDnVec(descr_x);
+  cusparseDestroyDnVec(descr_y);
+}
+
+void CudaPipeline::geam(const CudaMatrix &A, const CudaMatrix &B,
+                        CudaMatrix &C, double alpha, double beta,
+                        Operation op_A, Operation op_B) const {
+  Index rows_A = (op_A == Operation::None) ? A.rows() : A.cols();
+  Index cols_A = (op_A == Operation::None) ? A.cols() : A.rows();
+  Index rows_B = (op_B == Operation::None) ? B.rows() : B.cols();
+  Index cols_B = (op_B == Operation::None) ? B.cols() : B.rows();
+
+  if (rows_A != rows_B || cols_A != cols_B) {
+    throw std::runtime_error("Shape mismatch in Cublas geam");
+  }
+  C.resize(rows_A, cols_A);
+  cublasOperation_t blas_A = blas_operation(A, op_A);
+  cublasOperation_t blas_B = blas_operation(B, op_B);
+  int lda = int(A.leading_dimension());
+  int ldb = int(B.leading_dimension());
+  int ldc = int(C.leading_dimension());
+  if (is_row_major(C)) {
+    // C^T = alpha * op(A)^T + beta * op(B)^T
+    cublasDgeam(_handle, transposed(blas_A), transposed(blas_B), int(cols_A),
+                int(rows_A), &alpha, A.data(), lda, &beta, B.data(), ldb,
+                C.data(), ldc);
+  } else {
+    cublasDgeam(_handle, blas_A, blas_B, int(rows_A), int(cols_A), &alpha,
+                A.data(), lda, &beta, B.data(), ldb, C.data(), ldc);
+  }
+}
+
+void CudaPipeline::copy(const CudaMatrix &A, CudaMatrix &B) const {
+  if (A.storage_order() != B.storage_order()) {
+    // B keeps its storage order, transpose the buffer on the way
+    geam(A, A, B, 1., 0.);
+    return;
+  }
+  B.resize(A.rows(), A.cols());
+  checkCuda(cudaMemcpyAsync(B.data(), A.data(), A.size() * sizeof(double),
+                            cudaMemcpyDeviceToDevice, _stream));
+}
+
+namespace {
+void throw_if_shapes_differ(const CudaMatrix &A, const CudaMatrix &B,
+                            const std::string &operation) {
+  if (A.rows() != B.rows() || A.cols() != B.cols()) {
+    throw std::runtime_error("Shape mismatch in " + operation);
+  }
+  // Element-wise operations run over the raw buffers
+  if (A.storage_order() != B.storage_order()) {
+    throw std::runtime_error("Storage order mismatch in " + operation);
+  }
+}
+}  // namespace
+
+void CudaPipeline::scale(CudaMatrix &A, double alpha) const {
+  cublasDscal(_handle, int(A.size()), &alpha, A.data(), 1);
+}
+
+void CudaPipeline::axpy(double alpha, const CudaMatrix &X,
+                        CudaMatrix &Y) const {
+  throw_if_shapes_differ(X, Y, "axpy");
+  cublasDaxpy(_handle, int(X.size()), &alpha, X.data(), 1, Y.data(), 1);
+}
+
+void CudaPipeline::add(const CudaMatrix &A, const CudaMatrix &B,
+                       CudaMatrix &C) const {
+  geam(A, B, C, 1., 1.);
+}
+
+void CudaPipeline::hadamard_product(const CudaMatrix &A, const CudaMatrix &B,
+                                    CudaMatrix &C) const {
+  throw_if_shapes_differ(A, B, "hadamard product");
+  C.resize(A.rows(), A.cols(), A.storage_order());
+  checkCuda(kernels::hadamard_product(A.data(), B.data(), C.data(), A.size(),
+                                      _stream));
+}
+
+void CudaPipeline::hadamard_division(const CudaMatrix &A, const CudaMatrix &B,
+                                     CudaMatrix &C) const {
+  throw_if_shapes_differ(A, B, "hadamard division");
+  C.resize(A.rows(), A.cols(), A.storage_order());
+  checkCuda(kernels::hadamard_division(A.data(), B.data(), C.data(),
+                                       A.size(), _stream));
+}
+
+void CudaPipeline::apply(CudaMatrix &A, UnaryFunction function) const {
+  checkCuda(kernels::apply(A.data(), A.size(), function, _stream));
+}
+
+void CudaPipeline::random(CudaMatrix &A, Distribution distribution,
+                          std::uint64_t seed, std::uint64_t subsequence) const {
+  checkCuda(kernels::random(A.data(), A.size(), distribution, seed,
+                            subsequence, _stream));
+}
+
+double *CudaPipeline::reduction_buffer() const {
+  if (!_reduction_buffer) {
+    // The partial results plus the final one
+    Index size = kernels::reduction_buffer_size() + 1;
+    _reduction_buffer =
+        std::unique_ptr<CudaMatrix>(new CudaMatrix(size, 1, _stream));
+  }
+  return _reduction_buffer->data();
+}
+
+double CudaPipeline::download_scalar(const double *device_scalar) const {
+  double result;
+  checkCuda(cudaMemcpyAsync(&result, device_scalar, sizeof(double),
+                            cudaMemcpyDeviceToHost, _stream));
+  checkCuda(cudaStreamSynchronize(_stream));
+  return result;
+}
+
+double CudaPipeline::norm(const CudaMatrix &A, Norm type) const {
+  double result = 0.;
+  if (type == Norm::Frobenius) {
+    // cublas scales the sum of squares to avoid overflows
+    cublasDnrm2(_handle, int(A.size()), A.data(), 1, &result);
+  } else {
+    double *buffer = reduction_buffer();
+    double *device_result = buffer + kernels::reduction_buffer_size();
+    checkCuda(kernels::max_abs(A.data(), A.size(), buffer, device_result,
+                               _stream));
+    result = download_scalar(device_result);
+  }
+  return result;
+}
+
+double CudaPipeline::sum(const CudaMatrix &A) const {
+  double *buffer = reduction_buffer();
+  double *device_result = buffer + kernels::reduction_buffer_size();
+  checkCuda(
+      kernels::sum(A.data(), A.size(), 1, buffer, device_result, _stream));
+  return download_scalar(device_result);
+}
+
+double CudaPipeline::trace(const CudaMatrix &A) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("The trace is only defined for square matrices");
+  }
+  double *buffer = reduction_buffer();
+  double *device_result = buffer + kernels::reduction_buffer_size();
+  // The diagonal is the column-major data with a stride of rows + 1
+  checkCuda(kernels::sum(A.data(), A.rows(), A.rows() + 1, buffer,
+                         device_result, _stream));
+  return download_scalar(device_result);
+}
+
+double CudaPipeline::dot(const CudaMatrix &A, const CudaMatrix &B) const {
+  throw_if_shapes_differ(A, B, "dot");
+  double result = 0.;
+  cublasDdot(_handle, int(A.size()), A.data(), 1, B.data(), 1, &result);
+  return result;
+}
+
+Eigen::VectorXd CudaPipeline::column_norms(const CudaMatrix &A) const {
+  throw_if_row_major(A, "column_norms");
+  auto scope = workspace_scope();
+  CudaMatrix norms = scratch(A.cols(), 1);
+  checkCuda(kernels::column_norms(A.data(), A.rows(), A.cols(), norms.data(),
+                                  _stream));
+  return Eigen::MatrixXd(norms);
+}
+
+void CudaPipeline::throw_if_solver_failed(const CudaMatrix &info,
+                                          const std::string &routine) const {
+  int status;
+  checkCuda(cudaMemcpyAsync(&status, info.data(), sizeof(int),
+                            cudaMemcpyDeviceToHost, _stream));
+  checkCuda(cudaStreamSynchronize(_stream));
+  if (status != 0) {
+    std::ostringstream oss;
+    oss << "Cusolver " << routine << " failed with info = " << status << "\n";
+    throw std::runtime_error(oss.str());
+  }
+}
+
+void CudaPipeline::syevd(const CudaMatrix &A, CudaMatrix &eigenvalues,
+                         CudaMatrix &eigenvectors) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("The eigensolver requires a square matrix");
+  }
+  int n = int(A.rows());
+  // The eigenvectors overwrite the input
+  eigenvectors.resize(n, n, StorageOrder::ColMajor);
+  copy(A, eigenvectors);
+  eigenvalues.resize(n, 1);
+
+  auto scope = workspace_scope();
+  int lwork = 0;
+  cusolverDnDsyevd_bufferSize(_solver_handle, CUSOLVER_EIG_MODE_VECTOR,
+                              CUBLAS_FILL_MODE_LOWER, n, eigenvectors.data(),
+                              n, eigenvalues.data(), &lwork);
+  CudaMatrix work = scratch(lwork, 1);
+  CudaMatrix info = scratch(1, 1);
+  cusolverDnDsyevd(_solver_handle, CUSOLVER_EIG_MODE_VECTOR,
+                   CUBLAS_FILL_MODE_LOWER, n, eigenvectors.data(), n,
+                   eigenvalues.data(), work.data(), lwork,
+                   reinterpret_cast<int *>(info.data()));
+  throw_if_solver_failed(info, "syevd");
+}
+
+void CudaPipeline::syevdx(const CudaMatrix &A, Index first, Index count,
+                          CudaMatrix &eigenvalues,
+                          CudaMatrix &eigenvectors) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("The eigensolver requires a square matrix");
+  }
+  if (first < 0 || count < 1 || first + count > A.rows()) {
+    throw std::runtime_error("Eigenpairs requested out of range");
+  }
+  int n = int(A.rows());
+  // cusolver counts the eigenvalues from 1
+  int il = int(first) + 1;
+  int iu = int(first + count);
+  int found = 0;
+  eigenvectors.resize(n, n, StorageOrder::ColMajor);
+  copy(A, eigenvectors);
+  eigenvalues.resize(n, 1);
+
+  auto scope = workspace_scope();
+  int lwork = 0;
+  cusolverDnDsyevdx_bufferSize(
+      _solver_handle, CUSOLVER_EIG_MODE_VECTOR, CUSOLVER_EIG_RANGE_I,
+      CUBLAS_FILL_MODE_LOWER, n, eigenvectors.data(), n, 0., 0., il, iu,
+      &found, eigenvalues.data(), &lwork);
+  CudaMatrix work = scratch(lwork, 1);
+  CudaMatrix info = scratch(1, 1);
+  cusolverDnDsyevdx(_solver_handle, CUSOLVER_EIG_MODE_VECTOR,
+                    CUSOLVER_EIG_RANGE_I, CUBLAS_FILL_MODE_LOWER, n,
+                    eigenvectors.data(), n, 0., 0., il, iu, &found,
+                    eigenvalues.data(), work.data(), lwork,
+                    reinterpret_cast<int *>(info.data()));
+  throw_if_solver_failed(info, "syevdx");
+
+  // The requested eigenpairs are stored first, shrink without copying
+  eigenvalues.resize(count, 1);
+  eigenvectors.resize(n, count);
+}
+
+void CudaPipeline::orthonormalize(CudaMatrix &Y) const {
+  throw_if_row_major(Y, "orthonormalize");
+  int m = int(Y.rows());
+  int n = int(Y.cols());
+  auto scope = workspace_scope();
+  CudaMatrix tau = scratch(std::min(m, n), 1);
+  CudaMatrix info = scratch(1, 1);
+  int lwork_geqrf = 0;
+  int lwork_orgqr = 0;
+  cusolverDnDgeqrf_bufferSize(_solver_handle, m, n, Y.data(), m, &lwork_geqrf);
+  cusolverDnDorgqr_bufferSize(_solver_handle, m, n, n, Y.data(), m,
+                              tau.data(), &lwork_orgqr);
+  int lwork = std::max(lwork_geqrf, lwork_orgqr);
+  CudaMatrix work = scratch(lwork, 1);
+  // info only reports illegal arguments, which the shapes rule out. It is not
+  // read so that the factorization stays asynchronous
+  cusolverDnDgeqrf(_solver_handle, m, n, Y.data(), m, tau.data(), work.data(),
+                   lwork, reinterpret_cast<int *>(info.data()));
+  cusolverDnDorgqr(_solver_handle, m, n, n, Y.data(), m, tau.data(),
+                   work.data(), lwork, reinterpret_cast<int *>(info.data()));
+}
+
+void CudaPipeline::randomized_svd(const CudaMatrix &A, Index rank,
+                                  CudaMatrix &U, CudaMatrix &S, CudaMatrix &V,
+                                  Index oversampling, Index power_iterations,
+                                  std::uint64_t seed) const {
+  Index m = A.rows();
+  Index n = A.cols();
+  if (rank < 1 || rank > std::min(m, n)) {
+    throw std::runtime_error("The rank of the randomized SVD is out of range");
+  }
+  if (oversampling < 0 || power_iterations < 0) {
+    throw std::runtime_error(
+        "Negative oversampling or power iterations in the randomized SVD");
+  }
+  Index l = std::min(rank + oversampling, std::min(m, n));
+  auto scope = workspace_scope();
+
+  // Orthonormal basis Q of the range of A * Omega, Omega being Gaussian
+  CudaMatrix Z = scratch(n, l);
+  CudaMatrix Q = scratch(m, l);
+  random(Z, Distribution::Normal, seed);
+  gemm(A, Z, Q, 1., 0.);
+  orthonormalize(Q);
+  // Every product is orthonormalized, otherwise the rounding errors wipe out
+  // the smallest singular values of the range
+  for (Index i = 0; i < power_iterations; i++) {
+    gemm(A, Q, Z, 1., 0., Operation::Transpose);
+    orthonormalize(Z);
+    gemm(A, Z, Q, 1., 0.);
+    orthonormalize(Q);
+  }
+
+  // Z = A^T * Q = B^T is n x l, the tall shape required by gesvd. From
+  // B^T = W * S * X^T follows A ~ Q * B = (Q * X) * S * W^T
+  gemm(A, Q, Z, 1., 0., Operation::Transpose);
+  CudaMatrix X_T = scratch(l, l);
+  CudaMatrix superdiagonal = scratch(l, 1);
+  CudaMatrix info = scratch(1, 1);
+  V.resize(n, l, StorageOrder::ColMajor);
+  S.resize(l, 1, StorageOrder::ColMajor);
+  int lwork = 0;
+  cusolverDnDgesvd_bufferSize(_solver_handle, int(n), int(l), &lwork);
+  CudaMatrix work = scratch(lwork, 1);
+  cusolverDnDgesvd(_solver_handle, 'S', 'S', int(n), int(l), Z.data(), int(n),
+                   S.data(), V.data(), int(n), X_T.data(), int(l), work.data(),
+                   lwork, superdiagonal.data(),
+                   reinterpret_cast<int *>(info.data()));
+  throw_if_solver_failed(info, "gesvd");
+  U.resize(m, l, StorageOrder::ColMajor);
+  gemm(Q, X_T, U, 1., 0., Operation::None, Operation::Transpose);
+
+  // The singular values are descending, keep the leading columns in place
+  U.resize(m, rank);
+  S.resize(rank, 1);
+  V.resize(n, rank);
+}
+
+namespace {
+cublasFillMode_t fill_mode(Triangle triangle) {
+  return (triangle == Triangle::Upper) ? CUBLAS_FILL_MODE_UPPER
+                                       : CUBLAS_FILL_MODE_LOWER;
+}
+
+// Fill mode of the buffer of C, the triangles swap in row major storage
+cublasFillMode_t fill_mode(const CudaMatrix &C, Triangle triangle) {
+  if (is_row_major(C) && triangle != Triangle::Full) {
+    return fill_mode(triangle == Triangle::Lower ? Triangle::Upper
+                                                 : Triangle::Lower);
+  }
+  return fill_mode(triangle);
+}
+}  // namespace
+
+void CudaPipeline::syrk(const CudaMatrix &A, CudaMatrix &C, Triangle triangle,
+                        Operation op) const {
+  // op(A) is n x k
+  Index n = (op == Operation::None) ? A.rows() : A.cols();
+  Index k = (op == Operation::None) ? A.cols() : A.rows();
+  double alpha = 1.;
+  double beta = 0.;
+  C.resize(n, n);
+  cublasDsyrk(_handle, fill_mode(C, triangle), blas_operation(A, op), int(n),
+              int(k), &alpha, A.data(), int(A.leading_dimension()), &beta,
+              C.data(), int(n));
+  if (triangle == Triangle::Full) {
+    checkCuda(kernels::symmetrize(C.data(), n, true, _stream));
+  }
+}
+
+void CudaPipeline::syr2k(const CudaMatrix &A, const CudaMatrix &B,
+                         CudaMatrix &C, Triangle triangle,
+                         Operation op) const {
+  throw_if_shapes_differ(A, B, "syr2k");
+  Index n = (op == Operation::None) ? A.rows() : A.cols();
+  Index k = (op == Operation::None) ? A.cols() : A.rows();
+  double alpha = 1.;
+  double beta = 0.;
+  C.resize(n, n);
+  cublasDsyr2k(_handle, fill_mode(C, triangle), blas_operation(A, op), int(n),
+               int(k), &alpha, A.data(), int(A.leading_dimension()), B.data(),
+               int(B.leading_dimension()), &beta, C.data(), int(n));
+  if (triangle == Triangle::Full) {
+    checkCuda(kernels::symmetrize(C.data(), n, true, _stream));
+  }
+}
+
+void CudaPipeline::symm(const CudaMatrix &A, const CudaMatrix &B,
+                        CudaMatrix &C, Side side) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("symm requires a square symmetric matrix");
   }
-  cublasDgemm(_handle, CUBLAS_OP_N, CUBLAS_OP_N, int(A.rows()), int(B.cols()),
-              int(A.cols()), palpha, A.data(), int(A.rows()), B.data(),
-              int(B.rows()), pbeta, C.data(), int(C.rows()));
+  Index inner = (side == Side::Left) ? B.rows() : B.cols();
+  if (inner != A.rows()) {
+    throw std::runtime_error("Shape mismatch in Cublas symm");
+  }
+  double alpha = 1.;
+  double beta = 0.;
+  C.resize(B.rows(), B.cols(), B.storage_order());
+  // The lower triangle of a row major A is the upper one of its buffer, and
+  // a row major B turns A * B into B^T * A on the buffers
+  cublasFillMode_t fill =
+      is_row_major(A) ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER;
+  cublasSideMode_t mode = ((side == Side::Left) != is_row_major(B))
+                              ? CUBLAS_SIDE_LEFT
+                              : CUBLAS_SIDE_RIGHT;
+  Index stored_rows = B.leading_dimension();
+  Index stored_cols = is_row_major(B) ? B.rows() : B.cols();
+  cublasDsymm(_handle, mode, fill, int(stored_rows), int(stored_cols), &alpha,
+              A.data(), int(A.rows()), B.data(), int(stored_rows), &beta,
+              C.data(), int(stored_rows));
+}
+
+namespace {
+void throw_if_not_triangular(const CudaMatrix &A, Index inner,
+                             Triangle triangle, const std::string &operation) {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error(operation + " requires a square matrix");
+  }
+  if (triangle == Triangle::Full) {
+    throw std::runtime_error(operation +
+                             " requires the lower or the upper triangle");
+  }
+  if (inner != A.rows()) {
+    throw std::runtime_error("Shape mismatch in Cublas " + operation);
+  }
+}
+
+cublasDiagType_t diag_type(Diagonal diagonal) {
+  return (diagonal == Diagonal::Unit) ? CUBLAS_DIAG_UNIT : CUBLAS_DIAG_NON_UNIT;
+}
+
+// A row major B turns op(A) * B into B^T * op(A)^T on the buffers
+cublasSideMode_t side_mode(const CudaMatrix &B, Side side) {
+  return ((side == Side::Left) != is_row_major(B)) ? CUBLAS_SIDE_LEFT
+                                                   : CUBLAS_SIDE_RIGHT;
+}
+
+cublasOperation_t triangle_operation(const CudaMatrix &A, const CudaMatrix &B,
+                                     Operation op) {
+  cublasOperation_t blas_op = blas_operation(A, op);
+  return is_row_major(B) ? transposed(blas_op) : blas_op;
+}
+}  // namespace
+
+void CudaPipeline::trsm(const CudaMatrix &A, CudaMatrix &B, Side side,
+                        Triangle triangle, Operation op,
+                        Diagonal diagonal, double alpha) const {
+  Index inner = (side == Side::Left) ? B.rows() : B.cols();
+  throw_if_not_triangular(A, inner, triangle, "trsm");
+  Index stored_rows = B.leading_dimension();
+  Index stored_cols = is_row_major(B) ? B.rows() : B.cols();
+  cublasDtrsm(_handle, side_mode(B, side), fill_mode(A, triangle),
+              triangle_operation(A, B, op), diag_type(diagonal),
+              int(stored_rows), int(stored_cols), &alpha, A.data(),
+              int(std::max<Index>(A.rows(), 1)), B.data(),
+              int(std::max<Index>(stored_rows, 1)));
+}
+
+void CudaPipeline::trmm(const CudaMatrix &A, const CudaMatrix &B,
+                        CudaMatrix &C, Side side, Triangle triangle,
+                        Operation op, Diagonal diagonal,
+                        double alpha) const {
+  Index inner = (side == Side::Left) ? B.rows() : B.cols();
+  throw_if_not_triangular(A, inner, triangle, "trmm");
+  C.resize(B.rows(), B.cols(), B.storage_order());
+  Index stored_rows = B.leading_dimension();
+  Index stored_cols = is_row_major(B) ? B.rows() : B.cols();
+  cublasDtrmm(_handle, side_mode(B, side), fill_mode(A, triangle),
+              triangle_operation(A, B, op), diag_type(diagonal),
+              int(stored_rows), int(stored_cols), &alpha, A.data(),
+              int(std::max<Index>(A.rows(), 1)), B.data(),
+              int(std::max<Index>(stored_rows, 1)), C.data(),
+              int(std::max<Index>(stored_rows, 1)));
+}
+
+Eigen::MatrixXd CudaPipeline::copy_symmetric_to_host(const CudaMatrix &C,
+                                                     Triangle triangle) const {
+  if (triangle == Triangle::Full) {
+    return C;
+  }
+  if (C.rows() != C.cols()) {
+    throw std::runtime_error("A symmetric matrix must be square");
+  }
+  Index n = C.rows();
+  // The triangles swap in the buffer of a row major matrix
+  bool lower = (triangle == Triangle::Lower) != is_row_major(C);
+  CudaMatrix packed{n * (n + 1) / 2, 1, _stream};
+  checkCuda(kernels::pack_triangle(C.data(), n, lower, packed.data(), _stream));
+  Eigen::VectorXd host_packed = Eigen::MatrixXd(packed);
+
+  Eigen::MatrixXd result(n, n);
+  Index k = 0;
+  for (Index j = 0; j < n; j++) {
+    Index first = lower ? j : 0;
+    Index last = lower ? n : j + 1;
+    for (Index i = first; i < last; i++, k++) {
+      result(i, j) = result(j, i) = host_packed(k);
+    }
+  }
+  return result;
+}
+
+namespace {
+void throw_if_not_square(const CudaMatrix &A, const std::string &operation) {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error(operation + " requires a square matrix");
+  }
+}
+
+void throw_if_cannot_solve(Index rows, const CudaMatrix &B) {
+  if (B.rows() != rows) {
+    throw std::runtime_error("Shape mismatch in the right hand side");
+  }
+}
+}  // namespace
+
+CholeskyFactor CudaPipeline::potrf(const CudaMatrix &A) const {
+  throw_if_not_square(A, "Cholesky factorization");
+  int n = int(A.rows());
+  CudaMatrix factor{A.rows(), A.cols(), _stream};
+  copy(A, factor);
+
+  auto scope = workspace_scope();
+  int lwork = 0;
+  cusolverDnDpotrf_bufferSize(_solver_handle, CUBLAS_FILL_MODE_LOWER, n,
+                              factor.data(), n, &lwork);
+  CudaMatrix work = scratch(lwork, 1);
+  CudaMatrix info = scratch(1, 1);
+  cusolverDnDpotrf(_solver_handle, CUBLAS_FILL_MODE_LOWER, n, factor.data(),
+                   n, work.data(), lwork, reinterpret_cast<int *>(info.data()));
+  throw_if_solver_failed(info, "potrf");
+  return CholeskyFactor{std::move(factor)};
+}
+
+void CudaPipeline::potrs(const CholeskyFactor &factor, CudaMatrix &B) const {
+  throw_if_cannot_solve(factor.rows(), B);
+  throw_if_row_major(B, "potrs");
+  int n = int(factor.rows());
+  // info only reports the illegal arguments ruled out above, it is not read
+  // so that the solve runs asynchronously
+  auto scope = workspace_scope();
+  CudaMatrix info = scratch(1, 1);
+  cusolverDnDpotrs(_solver_handle, CUBLAS_FILL_MODE_LOWER, n, int(B.cols()),
+                   factor.matrix().data(), n, B.data(), int(B.rows()),
+                   reinterpret_cast<int *>(info.data()));
+}
+
+LUFactor CudaPipeline::getrf(const CudaMatrix &A) const {
+  throw_if_not_square(A, "LU factorization");
+  int n = int(A.rows());
+  CudaMatrix matrix{A.rows(), A.cols(), _stream};
+  copy(A, matrix);
+  LUFactor factor{std::move(matrix)};
+  double *lu = factor._factor.data();
+
+  auto scope = workspace_scope();
+  int lwork = 0;
+  cusolverDnDgetrf_bufferSize(_solver_handle, n, n, lu, n, &lwork);
+  CudaMatrix work = scratch(lwork, 1);
+  CudaMatrix info = scratch(1, 1);
+  cusolverDnDgetrf(_solver_handle, n, n, lu, n, work.data(),
+                   factor._pivots.get(), reinterpret_cast<int *>(info.data()));
+  throw_if_solver_failed(info, "getrf");
+  return factor;
+}
+
+void CudaPipeline::getrs(const LUFactor &factor, CudaMatrix &B) const {
+  throw_if_cannot_solve(factor.rows(), B);
+  throw_if_row_major(B, "getrs");
+  int n = int(factor.rows());
+  // Like in potrs, info is not read
+  auto scope = workspace_scope();
+  CudaMatrix info = scratch(1, 1);
+  cusolverDnDgetrs(_solver_handle, CUBLAS_OP_N, n, int(B.cols()),
+                   factor.matrix().data(), n, factor.pivots(), B.data(),
+                   int(B.rows()), reinterpret_cast<int *>(info.data()));
+}
+
+namespace {
+// Largest n accepted by cublas matinvBatched
+constexpr int max_matinv_size = 32;
+
+void throw_if_not_square(const CudaTensor &A, const std::string &operation) {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error(operation + " requires square matrices");
+  }
+}
+
+void throw_if_cannot_solve(Index rows, Index depth, const CudaTensor &B) {
+  if (B.rows() != rows || B.depth() != depth) {
+    throw std::runtime_error("Shape mismatch in the right hand sides");
+  }
+}
+
+double **as_pointers(const CudaMatrix &pointers) {
+  return reinterpret_cast<double **>(pointers.data());
+}
+
+int *as_statuses(const CudaMatrix &info) {
+  return reinterpret_cast<int *>(info.data());
+}
+
+// Doubles holding `count` ints
+Index ints(Index count) { return (count + 1) / 2; }
+
+// The batched factorizations overwrite their input
+CudaTensor duplicate(const CudaTensor &A, cudaStream_t stream) {
+  CudaTensor result{A.rows(), A.cols(), A.depth(), stream};
+  checkCuda(cudaMemcpyAsync(result.data(), A.data(), A.size() * sizeof(double),
+                            cudaMemcpyDeviceToDevice, stream));
+  return result;
+}
+}  // namespace
+
+CudaMatrix CudaPipeline::matrix_pointers(const CudaTensor &T) const {
+  CudaMatrix pointers = scratch(T.depth(), 1);
+  checkCuda(kernels::batch_pointers(T.data(), T.rows() * T.cols(), T.depth(),
+                                    as_pointers(pointers), _stream));
+  return pointers;
+}
+
+void CudaPipeline::throw_if_batch_failed(const CudaMatrix &info, Index batch,
+                                         const std::string &routine) const {
+  std::vector<int> statuses(batch);
+  checkCuda(cudaMemcpyAsync(statuses.data(), info.data(), batch * sizeof(int),
+                            cudaMemcpyDeviceToHost, _stream));
+  checkCuda(cudaStreamSynchronize(_stream));
+  for (Index i = 0; i < batch; i++) {
+    if (statuses[i] != 0) {
+      std::ostringstream oss;
+      oss << routine << " failed for matrix " << i
+          << " with info = " << statuses[i] << "\n";
+      throw std::runtime_error(oss.str());
+    }
+  }
+}
+
+BatchedCholeskyFactor CudaPipeline::potrf_batched(const CudaTensor &A) const {
+  throw_if_not_square(A, "Batched Cholesky factorization");
+  CudaTensor factors = duplicate(A, _stream);
+  BatchedCholeskyFactor factor{std::move(factors)};
+  if (A.size() == 0) {
+    return factor;
+  }
+  auto scope = workspace_scope();
+  CudaMatrix pointers = matrix_pointers(factor._factors);
+  CudaMatrix info = scratch(ints(A.depth()), 1);
+  cusolverDnDpotrfBatched(_solver_handle, CUBLAS_FILL_MODE_LOWER,
+                          int(A.rows()), as_pointers(pointers), int(A.rows()),
+                          as_statuses(info), int(A.depth()));
+  throw_if_batch_failed(info, A.depth(), "Cusolver potrfBatched");
+  return factor;
+}
+
+void CudaPipeline::potrs_batched(const BatchedCholeskyFactor &factor,
+                                 CudaTensor &B) const {
+  throw_if_cannot_solve(factor.rows(), factor.depth(), B);
+  if (B.size() == 0) {
+    return;
+  }
+  auto scope = workspace_scope();
+  CudaMatrix factors = matrix_pointers(factor.tensor());
+  CudaMatrix solutions = matrix_pointers(B);
+  int n = int(factor.rows());
+  double alpha = 1.;
+  // L_i * Y_i = B_i, then L_i^T * X_i = Y_i. Unlike potrsBatched of
+  // cusolver, the triangular solves take any number of right hand sides
+  for (cublasOperation_t op : {CUBLAS_OP_N, CUBLAS_OP_T}) {
+    cublasDtrsmBatched(_handle, CUBLAS_SIDE_LEFT, CUBLAS_FILL_MODE_LOWER, op,
+                       CUBLAS_DIAG_NON_UNIT, n, int(B.cols()), &alpha,
+                       as_pointers(factors), n, as_pointers(solutions), n,
+                       int(B.depth()));
+  }
+}
+
+BatchedLUFactor CudaPipeline::getrf_batched(const CudaTensor &A) const {
+  throw_if_not_square(A, "Batched LU factorization");
+  CudaTensor factors = duplicate(A, _stream);
+  BatchedLUFactor factor{std::move(factors)};
+  if (A.size() == 0) {
+    return factor;
+  }
+  auto scope = workspace_scope();
+  CudaMatrix pointers = matrix_pointers(factor._factors);
+  CudaMatrix info = scratch(ints(A.depth()), 1);
+  cublasDgetrfBatched(_handle, int(A.rows()), as_pointers(pointers),
+                      int(A.rows()), factor._pivots.get(), as_statuses(info),
+                      int(A.depth()));
+  throw_if_batch_failed(info, A.depth(), "Cublas getrfBatched");
+  return factor;
+}
+
+void CudaPipeline::getrs_batched(const BatchedLUFactor &factor,
+                                 CudaTensor &B) const {
+  throw_if_cannot_solve(factor.rows(), factor.depth(), B);
+  if (B.size() == 0) {
+    return;
+  }
+  auto scope = workspace_scope();
+  CudaMatrix factors = matrix_pointers(factor.tensor());
+  CudaMatrix solutions = matrix_pointers(B);
+  int n = int(factor.rows());
+  // Only the arguments are checked, in the host
+  int info = 0;
+  cublasDgetrsBatched(_handle, CUBLAS_OP_N, n, int(B.cols()),
+                      as_pointers(factors), n, factor.pivots(),
+                      as_pointers(solutions), n, &info, int(B.depth()));
+  if (info != 0) {
+    throw std::runtime_error("Invalid argument of cublas getrsBatched");
+  }
+}
+
+void CudaPipeline::inverse_batched(const CudaTensor &A,
+                                   CudaTensor &inverse) const {
+  throw_if_not_square(A, "Batched inversion");
+  inverse.resize(A.rows(), A.cols(), A.depth());
+  if (A.size() == 0) {
+    return;
+  }
+  int n = int(A.rows());
+  if (n <= max_matinv_size) {
+    auto scope = workspace_scope();
+    CudaMatrix matrices = matrix_pointers(A);
+    CudaMatrix inverses = matrix_pointers(inverse);
+    CudaMatrix info = scratch(ints(A.depth()), 1);
+    cublasDmatinvBatched(_handle, n, as_pointers(matrices), n,
+                         as_pointers(inverses), n, as_statuses(info),
+                         int(A.depth()));
+    throw_if_batch_failed(info, A.depth(), "Cublas matinvBatched");
+    return;
+  }
+  BatchedLUFactor factor = getrf_batched(A);
+  auto scope = workspace_scope();
+  CudaMatrix factors = matrix_pointers(factor.tensor());
+  CudaMatrix inverses = matrix_pointers(inverse);
+  CudaMatrix info = scratch(ints(A.depth()), 1);
+  cublasDgetriBatched(_handle, n, as_pointers(factors), n, factor.pivots(),
+                      as_pointers(inverses), n, as_statuses(info),
+                      int(A.depth()));
+  throw_if_batch_failed(info, A.depth(), "Cublas getriBatched");
+}
+
+void CudaPipeline::einsum(const std::string &expression,
+                          const std::vector<CudaOperand> &operands,
+                          CudaMatrix &result) const {
+  std::vector<Shape> shapes;
+  for (const CudaOperand &operand : operands) {
+    shapes.push_back(operand.shape);
+  }
+  contract(ContractionPlan{expression, shapes}, operands, result);
+}
+
+void CudaPipeline::contract(const ContractionPlan &plan,
+                            const std::vector<CudaOperand> &operands,
+                            CudaMatrix &result) const {
+  std::vector<Shape> shapes;
+  std::vector<double *> slots;
+  for (const CudaOperand &operand : operands) {
+    throw_if_row_major(operand.matrix, "contract");
+    if (operand.matrix.size() != shape_size(operand.shape)) {
+      throw std::runtime_error(
+          "The shape of an operand does not match its size");
+    }
+    shapes.push_back(operand.shape);
+    slots.push_back(operand.matrix.data());
+  }
+  plan.throw_if_incompatible(shapes);
+
+  // Intermediate results, taken from the workspace when one is reserved.
+  // The last slot is the result itself
+  auto scope = workspace_scope();
+  const std::vector<Index> &sizes = plan.slot_sizes();
+  std::vector<CudaMatrix> temporaries;
+  temporaries.reserve(sizes.size());
+  for (int slot = int(slots.size()); slot < plan.result_slot(); slot++) {
+    temporaries.push_back(scratch(sizes[slot], 1));
+    slots.push_back(temporaries.back().data());
+  }
+  result.resize(plan.result_rows(), plan.result_cols(),
+                StorageOrder::ColMajor);
+  slots.push_back(result.data());
+
+  // The sums are products with a vector of ones
+  Index max_summed = 0;
+  for (const ContractionStep &step : plan.steps()) {
+    if (step.kind == ContractionStep::Kind::Sum) {
+      max_summed = std::max(max_summed, step.k);
+    }
+  }
+  Eigen::MatrixXd host_ones = Eigen::MatrixXd::Ones(max_summed, 1);
+  CudaMatrix ones = scratch(max_summed, 1);
+  checkCuda(cudaMemcpyAsync(ones.data(), host_ones.data(),
+                            max_summed * sizeof(double),
+                            cudaMemcpyHostToDevice, _stream));
+
+  double alpha = 1.;
+  double beta = 0.;
+  for (const ContractionStep &step : plan.steps()) {
+    const double *A = slots[step.input];
+    double *C = slots[step.output];
+    switch (step.kind) {
+      case ContractionStep::Kind::Permute:
+        checkCuda(kernels::permute(A, step.dims.data(),
+                                   step.permutation.data(),
+                                   int(step.dims.size()), C, _stream));
+        break;
+      case ContractionStep::Kind::Sum:
+        cublasDgemv(_handle, CUBLAS_OP_N, int(step.m), int(step.k), &alpha, A,
+                    int(std::max<Index>(step.m, 1)), ones.data(), 1, &beta, C,
+                    1);
+        break;
+      case ContractionStep::Kind::Gemm: {
+        Index lda = (step.op_A == Operation::None) ? step.m : step.k;
+        Index ldb = (step.op_B == Operation::None) ? step.k : step.n;
+        cublasDgemmStridedBatched(
+            _handle, cublas_operation(step.op_A), cublas_operation(step.op_B),
+            int(step.m), int(step.n), int(step.k), &alpha, A,
+            int(std::max<Index>(lda, 1)), step.m * step.k, slots[step.other],
+            int(std::max<Index>(ldb, 1)), step.k * step.n, &beta, C,
+            int(std::max<Index>(step.m, 1)), step.m * step.n,
+            int(step.batch));
+        break;
+      }
+    }
+  }
+}
+
+void CudaPipeline::chain_product(const ChainOperands<CudaMatrix> &operands,
+                                 CudaMatrix &result) const {
+  chain_product(ChainPlan{ChainPlan::dims_of(operands)}, operands, result);
+}
+
+void CudaPipeline::chain_product(const ChainPlan &plan,
+                                 const ChainOperands<CudaMatrix> &operands,
+                                 CudaMatrix &result) const {
+  plan.throw_if_incompatible(ChainPlan::dims_of(operands));
+  if (plan.steps().empty()) {
+    copy(operands.front(), result);
+    return;
+  }
+  auto scope = workspace_scope();
+  int first_temporary = int(operands.size());
+  const std::vector<Index> &sizes = plan.slot_sizes();
+  std::vector<CudaMatrix> temporaries;
+  temporaries.reserve(sizes.size());
+  for (int slot = first_temporary; slot < plan.result_slot(); slot++) {
+    temporaries.push_back(scratch(sizes[slot], 1));
+  }
+  // The products reshape the temporaries within their capacity
+  auto output = [&](int slot) -> CudaMatrix & {
+    return (slot == plan.result_slot()) ? result
+                                        : temporaries[slot - first_temporary];
+  };
+  auto input = [&](int slot) -> const CudaMatrix & {
+    return (slot < first_temporary) ? operands[slot].get() : output(slot);
+  };
+  for (const ChainStep &step : plan.steps()) {
+    gemm(input(step.left), input(step.right), output(step.output));
+  }
+}
+
+void CudaPipeline::synchronize() const {
+  checkCuda(cudaStreamSynchronize(_stream));
+}
+
+void CudaPipeline::set_deterministic(bool deterministic) {
+  _deterministic = deterministic;
+  // Atomics are forbidden by default, pin them in case they were enabled
+  if (deterministic) {
+    cublasSetAtomicsMode(_handle, CUBLAS_ATOMICS_NOT_ALLOWED);
+  }
+  cublasSetMathMode(_handle,
+                    deterministic ? CUBLAS_PEDANTIC_MATH : CUBLAS_DEFAULT_MATH);
+  // Deterministic results are the cusolver default, leaving the mode restores
+  // it. Before cusolver 11.5 there is no other mode
+#if defined(CUSOLVER_VERSION) && CUSOLVER_VERSION >= 11500
+  cusolverDnSetDeterministicMode(_solver_handle,
+                                 CUSOLVER_DETERMINISTIC_RESULTS);
+#endif
+}
+
+void CudaPipeline::reserve_workspace(size_t bytes) {
+  // release the previous block before reserving the new one
+  _workspace.reset();
+  _workspace = std::unique_ptr<Workspace>(new Workspace(bytes, _stream));
+}
+
+CudaMatrix CudaPipeline::scratch(Index nrows, Index ncols) const {
+  if (_workspace) {
+    return _workspace->matrix(nrows, ncols);
+  }
+  return CudaMatrix{nrows, ncols, _stream};
+}
+
+std::unique_ptr<Workspace::Scope> CudaPipeline::workspace_scope() const {
+  if (!_workspace) {
+    return nullptr;
+  }
+  return std::unique_ptr<Workspace::Scope>(new Workspace::Scope(*_workspace));
+}
+
+Workspace &CudaPipeline::workspace() const {
+  if (!_workspace) {
+    throw std::runtime_error("There is no workspace reserved in the pipeline");
+  }
+  return *_workspace;
+}
+
+StagingRing &CudaPipeline::staging() {
+  if (!_staging) {
+    _staging = std::unique_ptr<StagingRing>(new StagingRing());
+  }
+  return *_staging;
+}
+
+namespace {
+bool is_pinned(const void *ptr) {
+  cudaPointerAttributes attributes;
+  if (cudaPointerGetAttributes(&attributes, ptr) != cudaSuccess) {
+    // Older runtimes flag unregistered memory as an error, clear it
+    cudaGetLastError();
+    return false;
+  }
+  return attributes.type == cudaMemoryTypeHost;
+}
+}  // namespace
+
+void CudaPipeline::copy_to_gpu(const Eigen::MatrixXd &A, CudaMatrix &B) {
+  B.resize(A.rows(), A.cols(), StorageOrder::ColMajor);
+  upload(A.data(), B);
+}
+
+void CudaPipeline::copy_to_gpu(const RowMajorMatrixXd &A, CudaMatrix &B) {
+  B.resize(A.rows(), A.cols(), StorageOrder::RowMajor);
+  upload(A.data(), B);
+}
+
+void CudaPipeline::copy_to_host(const CudaMatrix &A, Eigen::MatrixXd &B) {
+  if (is_row_major(A)) {
+    B = A;
+    return;
+  }
+  B.resize(A.rows(), A.cols());
+  download(A, B.data());
+}
+
+void CudaPipeline::copy_to_host(const CudaMatrix &A, RowMajorMatrixXd &B) {
+  if (!is_row_major(A)) {
+    B = A;
+    return;
+  }
+  B.resize(A.rows(), A.cols());
+  download(A, B.data());
+}
+
+void CudaPipeline::upload(const double *host, CudaMatrix &B) {
+  size_t bytes = B.size() * sizeof(double);
+  if (bytes <= StagingRing::default_chunk_bytes || is_pinned(host)) {
+    checkCuda(cudaMemcpyAsync(B.data(), host, bytes, cudaMemcpyHostToDevice,
+                              _stream));
+  } else {
+    staging().upload(B.data(), host, bytes, _stream);
+  }
+}
+
+void CudaPipeline::download(const CudaMatrix &A, double *host) {
+  size_t bytes = A.size() * sizeof(double);
+  if (bytes <= StagingRing::default_chunk_bytes || is_pinned(host)) {
+    checkCuda(cudaMemcpyAsync(host, A.data(), bytes, cudaMemcpyDeviceToHost,
+                              _stream));
+    checkCuda(cudaStreamSynchronize(_stream));
+  } else {
+    staging().download(host, A.data(), bytes, _stream);
+  }
+}
+
+namespace {
+void throw_if_not_managed(const CudaMatrix &A) {
+  if (A.memory_kind() != MemoryKind::Managed) {
+    throw std::runtime_error("Memory hints require a managed matrix");
+  }
+}
+}  // namespace
+
+void CudaPipeline::prefetch_to_device(const CudaMatrix &A) const {
+  throw_if_not_managed(A);
+  size_t bytes = A.size() * sizeof(double);
+  checkCuda(cudaMemPrefetchAsync(A.data(), bytes, _device, _stream));
+}
+
+void CudaPipeline::prefetch_to_host(const CudaMatrix &A) const {
+  throw_if_not_managed(A);
+  size_t bytes = A.size() * sizeof(double);
+  checkCuda(cudaMemPrefetchAsync(A.data(), bytes, cudaCpuDeviceId, _stream));
+}
+
+void CudaPipeline::advise_read_mostly(const CudaMatrix &A,
+                                      bool read_mostly) const {
+  throw_if_not_managed(A);
+  size_t bytes = A.size() * sizeof(double);
+  cudaMemoryAdvise advice = read_mostly ? cudaMemAdviseSetReadMostly
+                                        : cudaMemAdviseUnsetReadMostly;
+  checkCuda(cudaMemAdvise(A.data(), bytes, advice, _device));
 }
 
 }  // namespace eigencuda
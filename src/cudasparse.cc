@@ -0,0 +1,111 @@
+#include "cudasparse.hpp"
+
+namespace eigencuda {
+
+CudaSparseMatrix::CudaSparseMatrix(const Eigen::SparseMatrix<double> &matrix,
+                                   const cudaStream_t &stream)
+    : _rows{static_cast<Index>(matrix.rows())},
+      _cols{static_cast<Index>(matrix.cols())},
+      _stream{stream},
+      _values{static_cast<Index>(matrix.nonZeros()), 1, stream} {
+  // Eigen stores the transpose of a column major matrix as row major
+  Eigen::SparseMatrix<double, Eigen::RowMajor, int> csr = matrix;
+  csr.makeCompressed();
+
+  _row_offsets = alloc_indices_in_gpu(_rows + 1);
+  _column_indices = alloc_indices_in_gpu(nonzeros());
+  checkCuda(cudaMemcpyAsync(_row_offsets.get(), csr.outerIndexPtr(),
+                            (_rows + 1) * sizeof(int), cudaMemcpyHostToDevice,
+                            stream));
+  checkCuda(cudaMemcpyAsync(_column_indices.get(), csr.innerIndexPtr(),
+                            nonzeros() * sizeof(int), cudaMemcpyHostToDevice,
+                            stream));
+  checkCuda(cudaMemcpyAsync(_values.data(), csr.valuePtr(),
+                            nonzeros() * sizeof(double),
+                            cudaMemcpyHostToDevice, stream));
+  // The host buffers must outlive the transfers
+  checkCuda(cudaStreamSynchronize(stream));
+  create_descriptor();
+}
+
+CudaSparseMatrix::CudaSparseMatrix(Index rows, Index cols, Index nonzeros,
+                                   const cudaStream_t &stream)
+    : _rows{rows}, _cols{cols}, _stream{stream}, _values{nonzeros, 1, stream} {
+  _row_offsets = alloc_indices_in_gpu(_rows + 1);
+  _column_indices = alloc_indices_in_gpu(nonzeros);
+}
+
+void CudaSparseMatrix::create_descriptor() {
+  cusparseSpMatDescr_t descriptor;
+  cusparseCreateCsr(&descriptor, _rows, _cols, nonzeros(), _row_offsets.get(),
+                    _column_indices.get(), _values.data(), CUSPARSE_INDEX_32I,
+                    CUSPARSE_INDEX_32I, CUSPARSE_INDEX_BASE_ZERO, CUDA_R_64F);
+  _descriptor.reset(descriptor);
+}
+
+const CudaSparseMatrix &CudaSparseMatrix::transpose(
+    cusparseHandle_t handle) const {
+  if (_transpose) {
+    return *_transpose;
+  }
+  // The CSC arrays of a matrix are the CSR arrays of its transpose
+  std::unique_ptr<CudaSparseMatrix> transpose{
+      new CudaSparseMatrix{_cols, _rows, nonzeros(), _stream}};
+  size_t bytes = 0;
+  cusparseCsr2cscEx2_bufferSize(
+      handle, int(_rows), int(_cols), int(nonzeros()), _values.data(),
+      _row_offsets.get(), _column_indices.get(), transpose->_values.data(),
+      transpose->_row_offsets.get(), transpose->_column_indices.get(),
+      CUDA_R_64F, CUSPARSE_ACTION_NUMERIC, CUSPARSE_INDEX_BASE_ZERO,
+      CUSPARSE_CSR2CSC_ALG1, &bytes);
+  CudaMatrix buffer{Index(bytes / sizeof(double)) + 1, 1, _stream};
+  cusparseCsr2cscEx2(
+      handle, int(_rows), int(_cols), int(nonzeros()), _values.data(),
+      _row_offsets.get(), _column_indices.get(), transpose->_values.data(),
+      transpose->_row_offsets.get(), transpose->_column_indices.get(),
+      CUDA_R_64F, CUSPARSE_ACTION_NUMERIC, CUSPARSE_INDEX_BASE_ZERO,
+      CUSPARSE_CSR2CSC_ALG1, buffer.data());
+  transpose->create_descriptor();
+  _transpose = std::move(transpose);
+  return *_transpose;
+}
+
+CudaSparseMatrix::Unique_ptr_to_GPU_indices
+    CudaSparseMatrix::alloc_indices_in_gpu(Index size) const {
+  int *indices;
+  cudaError_t err = cudaMalloc(&indices, size * sizeof(int));
+  if (err != cudaSuccess) {
+    throw std::runtime_error("Error allocating sparse indices in the device");
+  }
+  return Unique_ptr_to_GPU_indices{indices,
+                                   [](int *x) { checkCuda(cudaFree(x)); }};
+}
+
+CudaSparseMatrix::operator Eigen::SparseMatrix<double>() const {
+  std::vector<int> row_offsets(_rows + 1);
+  std::vector<int> column_indices(nonzeros());
+  std::vector<double> values(nonzeros());
+  checkCuda(cudaMemcpyAsync(row_offsets.data(), _row_offsets.get(),
+                            (_rows + 1) * sizeof(int), cudaMemcpyDeviceToHost,
+                            _stream));
+  checkCuda(cudaMemcpyAsync(column_indices.data(), _column_indices.get(),
+                            nonzeros() * sizeof(int), cudaMemcpyDeviceToHost,
+                            _stream));
+  checkCuda(cudaMemcpyAsync(values.data(), _values.data(),
+                            nonzeros() * sizeof(double),
+                            cudaMemcpyDeviceToHost, _stream));
+  checkCuda(cudaStreamSynchronize(_stream));
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(values.size());
+  for (Index row = 0; row < _rows; row++) {
+    for (int k = row_offsets[row]; k < row_offsets[row + 1]; k++) {
+      triplets.emplace_back(row, column_indices[k], values[k]);
+    }
+  }
+  Eigen::SparseMatrix<double> result(_rows, _cols);
+  result.setFromTriplets(triplets.begin(), triplets.end());
+  return result;
+}
+
+}  // namespace eigencuda
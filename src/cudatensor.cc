@@ -0,0 +1,74 @@
+#include "cudatensor.hpp"
+
+namespace eigencuda {
+
+CudaTensor::CudaTensor(Index rows, Index cols, Index depth,
+                       const cudaStream_t &stream)
+    : _rows{rows},
+      _cols{cols},
+      _depth{depth},
+      _matrix{rows, cols * depth, stream} {}
+
+CudaTensor::CudaTensor(const std::vector<Eigen::MatrixXd> &matrices,
+                       const cudaStream_t &stream)
+    : CudaTensor{0, 0, 0, stream} {
+  copy_to_gpu(matrices);
+}
+
+void CudaTensor::resize(Index rows, Index cols, Index depth) {
+  _matrix.resize(rows, cols * depth);
+  _rows = rows;
+  _cols = cols;
+  _depth = depth;
+}
+
+CudaMatrix CudaTensor::slice(Index i) const {
+  if (i < 0 || i >= _depth) {
+    throw std::runtime_error("Slice " + std::to_string(i) +
+                             " is out of the tensor");
+  }
+  return CudaMatrix{data() + i * _rows * _cols, _rows, _cols,
+                    _matrix.stream(), _matrix.memory_kind()};
+}
+
+void CudaTensor::copy_to_gpu(const std::vector<Eigen::MatrixXd> &matrices) {
+  Index rows = matrices.empty() ? 0 : matrices.front().rows();
+  Index cols = matrices.empty() ? 0 : matrices.front().cols();
+  Index depth = static_cast<Index>(matrices.size());
+  // Pack the matrices on the host so that they move in a single transfer
+  Eigen::MatrixXd packed(rows, cols * depth);
+  for (Index i = 0; i < depth; i++) {
+    if (matrices[i].rows() != rows || matrices[i].cols() != cols) {
+      throw std::runtime_error("The matrices of a tensor must share a shape");
+    }
+    packed.middleCols(i * cols, cols) = matrices[i];
+  }
+  copy_to_gpu(packed.data(), rows, cols, depth);
+  // The packed buffer must outlive the transfer
+  checkCuda(cudaStreamSynchronize(_matrix.stream()));
+}
+
+void CudaTensor::copy_to_gpu(const double *host, Index rows, Index cols,
+                             Index depth) {
+  resize(rows, cols, depth);
+  checkCuda(cudaMemcpyAsync(data(), host, size() * sizeof(double),
+                            cudaMemcpyHostToDevice, _matrix.stream()));
+}
+
+CudaTensor::operator std::vector<Eigen::MatrixXd>() const {
+  Eigen::MatrixXd packed = _matrix;
+  std::vector<Eigen::MatrixXd> matrices;
+  matrices.reserve(_depth);
+  for (Index i = 0; i < _depth; i++) {
+    matrices.push_back(packed.middleCols(i * _cols, _cols));
+  }
+  return matrices;
+}
+
+void CudaTensor::copy_to_host(double *host) const {
+  checkCuda(cudaMemcpyAsync(host, data(), size() * sizeof(double),
+                            cudaMemcpyDeviceToHost, _matrix.stream()));
+  checkCuda(cudaStreamSynchronize(_matrix.stream()));
+}
+
+}  // namespace eigencuda
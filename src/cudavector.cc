@@ -0,0 +1,33 @@
+#include "cudavector.hpp"
+
+namespace eigencuda {
+
+CudaVector::CudaVector(const Eigen::VectorXd &vector,
+                       const cudaStream_t &stream)
+    : CudaMatrix{static_cast<Index>(vector.size()), 1, stream} {
+  copy_to_gpu(vector);
+}
+
+CudaVector::CudaVector(Index size, const cudaStream_t &stream)
+    : CudaMatrix{size, 1, stream} {}
+
+CudaVector::operator Eigen::VectorXd() const {
+  Eigen::VectorXd result;
+  copy_to_host(result);
+  checkCuda(cudaStreamSynchronize(this->stream()));
+  return result;
+}
+
+void CudaVector::copy_to_gpu(const Eigen::VectorXd &v) {
+  this->resize(static_cast<Index>(v.size()), 1);
+  checkCuda(cudaMemcpyAsync(this->data(), v.data(), v.size() * sizeof(double),
+                            cudaMemcpyHostToDevice, this->stream()));
+}
+
+void CudaVector::copy_to_host(Eigen::VectorXd &v) const {
+  v.resize(this->size());
+  checkCuda(cudaMemcpyAsync(v.data(), this->data(), v.size() * sizeof(double),
+                            cudaMemcpyDeviceToHost, this->stream()));
+}
+
+}  // namespace eigencuda
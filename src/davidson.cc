@@ -0,0 +1,235 @@
+#include "cudakernels.hpp"
+#include "cudapipeline.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace eigencuda {
+
+namespace {
+// Fraction of its norm a new vector must keep after the projection on the
+// subspace and the previous vectors, below it the vector is dependent
+constexpr double min_new_direction = 1e-8;
+
+struct DavidsonSizes {
+  Index block;
+  Index max_subspace;
+};
+
+DavidsonSizes davidson_sizes(Index n, Index count,
+                             const DavidsonOptions &options) {
+  if (count < 1 || count > n) {
+    throw std::runtime_error("The number of Davidson eigenpairs is invalid");
+  }
+  Index block = (options.block_size > 0) ? options.block_size : count;
+  Index max_subspace = (options.max_subspace > 0)
+                           ? options.max_subspace
+                           : std::min(n, std::max(count + block, 8 * block));
+  if (count + block > max_subspace || max_subspace > n) {
+    throw std::runtime_error(
+        "The Davidson subspace must hold the eigenpairs plus a block and fit "
+        "in the matrix");
+  }
+  return DavidsonSizes{block, max_subspace};
+}
+
+// Unit vectors on the smallest diagonal entries, the usual guess for
+// diagonally dominant matrices
+Eigen::MatrixXd initial_guess(const Eigen::VectorXd &diagonal, Index size) {
+  std::vector<Index> order(diagonal.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::partial_sort(
+      order.begin(), order.begin() + size, order.end(),
+      [&diagonal](Index i, Index j) { return diagonal(i) < diagonal(j); });
+  Eigen::MatrixXd guess = Eigen::MatrixXd::Zero(diagonal.size(), size);
+  for (Index j = 0; j < size; j++) {
+    guess(order[j], j) = 1.;
+  }
+  return guess;
+}
+}  // namespace
+
+DavidsonResult CudaPipeline::davidson(const CudaMatrix &A, Index count,
+                                      CudaMatrix &eigenvalues,
+                                      CudaMatrix &eigenvectors,
+                                      const DavidsonOptions &options) const {
+  if (A.rows() != A.cols()) {
+    throw std::runtime_error("The Davidson solver requires a square matrix");
+  }
+  Index n = A.rows();
+  auto scope = workspace_scope();
+  // Strided copy of the diagonal, the same in both storage orders
+  CudaMatrix diagonal = scratch(n, 1);
+  checkCuda(cudaMemcpy2DAsync(diagonal.data(), sizeof(double), A.data(),
+                              (n + 1) * sizeof(double), sizeof(double), n,
+                              cudaMemcpyDeviceToDevice, _stream));
+  LinearOperator apply = [this, &A](const CudaMatrix &X, CudaMatrix &Y) {
+    gemm(A, X, Y);
+  };
+  return davidson(apply, diagonal, count, eigenvalues, eigenvectors, options);
+}
+
+DavidsonResult CudaPipeline::davidson(const LinearOperator &apply,
+                                      const CudaMatrix &diagonal, Index count,
+                                      CudaMatrix &eigenvalues,
+                                      CudaMatrix &eigenvectors,
+                                      const DavidsonOptions &options) const {
+  if (diagonal.cols() != 1) {
+    throw std::runtime_error("The Davidson diagonal must be a column");
+  }
+  Index n = diagonal.rows();
+  DavidsonSizes sizes = davidson_sizes(n, count, options);
+  Index block = sizes.block;
+  Index max_subspace = sizes.max_subspace;
+  // The first subspace holds at least one vector per eigenpair
+  Index initial = std::max(count, block);
+
+  auto scope = workspace_scope();
+  // Orthonormal basis V of the subspace and AV = A * V, the first m columns
+  // are in use
+  CudaMatrix V = scratch(n, max_subspace);
+  CudaMatrix AV = scratch(n, max_subspace);
+  CudaMatrix H = scratch(max_subspace, max_subspace);
+  CudaMatrix theta = scratch(max_subspace, 1);
+  CudaMatrix S = scratch(max_subspace, max_subspace);
+  // Ritz vectors of the lowest pairs, their images and residuals
+  CudaMatrix X = scratch(n, count);
+  CudaMatrix AX = scratch(n, count);
+  CudaMatrix R = scratch(n, count);
+
+  Eigen::MatrixXd guess = initial_guess(Eigen::MatrixXd(diagonal), initial);
+  CudaMatrix first_block = V.middle_cols(0, initial);
+  first_block.copy_to_gpu(guess);
+
+  DavidsonResult result;
+  Index m = 0;
+  // Candidate directions stored in the columns of V from m
+  Index candidates = initial;
+  while (true) {
+    Index added = orthogonalize_block(V, m, candidates);
+    // Stagnation, the subspace cannot grow any more
+    if (added == 0) {
+      break;
+    }
+    CudaMatrix W = V.middle_cols(m, added);
+    CudaMatrix AW = AV.middle_cols(m, added);
+    apply(W, AW);
+    m += added;
+
+    // Rayleigh-Ritz: eigenpairs of H = V^T * A * V
+    CudaMatrix basis = V.middle_cols(0, m);
+    CudaMatrix image = AV.middle_cols(0, m);
+    gemm(basis, image, H, 1., 0., Operation::Transpose);
+    syevd(H, theta, S);
+    CudaMatrix coefficients = S.middle_cols(0, count);
+    gemm(basis, coefficients, X);
+    gemm(image, coefficients, AX);
+    checkCuda(kernels::ritz_residuals(X.data(), AX.data(), theta.data(), n,
+                                      count, R.data(), _stream));
+    result.residual_norms = column_norms(R);
+    result.iterations++;
+
+    std::vector<Index> unconverged;
+    for (Index j = 0; j < count; j++) {
+      if (result.residual_norms(j) > options.tolerance) {
+        unconverged.push_back(j);
+      }
+    }
+    result.converged = unconverged.empty();
+    if (result.converged || result.iterations >= options.max_iterations) {
+      break;
+    }
+
+    // Restart on the Ritz vectors when the next block does not fit
+    candidates = std::min(block, Index(unconverged.size()));
+    if (m + candidates > max_subspace) {
+      CudaMatrix ritz_vectors = V.middle_cols(0, count);
+      CudaMatrix ritz_images = AV.middle_cols(0, count);
+      copy(X, ritz_vectors);
+      copy(AX, ritz_images);
+      m = count;
+    }
+
+    // Preconditioned residuals of the lowest unconverged pairs
+    checkCuda(kernels::davidson_correction(R.data(), diagonal.data(),
+                                           theta.data(), n, count, R.data(),
+                                           _stream));
+    for (Index c = 0; c < candidates; c++) {
+      checkCuda(cudaMemcpyAsync(V.data() + (m + c) * n,
+                                R.data() + unconverged[c] * n,
+                                n * sizeof(double), cudaMemcpyDeviceToDevice,
+                                _stream));
+    }
+  }
+
+  eigenvalues.resize(count, 1);
+  checkCuda(cudaMemcpyAsync(eigenvalues.data(), theta.data(),
+                            count * sizeof(double), cudaMemcpyDeviceToDevice,
+                            _stream));
+  copy(X, eigenvectors);
+  return result;
+}
+
+Index CudaPipeline::orthogonalize_block(CudaMatrix &V, Index m,
+                                        Index candidates) const {
+  Index n = V.rows();
+  auto scope = workspace_scope();
+  CudaMatrix W = V.middle_cols(m, candidates);
+  // Norms of the candidates followed by the diagonal of their R factor,
+  // downloaded together
+  CudaMatrix lengths = scratch(2 * candidates, 1);
+  checkCuda(kernels::column_norms(W.data(), n, candidates, lengths.data(),
+                                  _stream));
+  // Projecting twice recovers the orthogonality lost to rounding
+  if (m > 0) {
+    CudaMatrix basis = V.middle_cols(0, m);
+    CudaMatrix projection = scratch(m, candidates);
+    for (int pass = 0; pass < 2; pass++) {
+      gemm(basis, W, projection, 1., 0., Operation::Transpose);
+      gemm(basis, projection, W, -1., 1.);
+    }
+  }
+
+  // |R_jj| is what candidate j adds to the previous ones, the QR runs on a
+  // copy to keep the candidates for the compaction
+  CudaMatrix factor = scratch(n, candidates);
+  copy(W, factor);
+  CudaMatrix tau = scratch(candidates, 1);
+  int lwork = 0;
+  cusolverDnDgeqrf_bufferSize(_solver_handle, int(n), int(candidates),
+                              factor.data(), int(n), &lwork);
+  CudaMatrix work = scratch(lwork, 1);
+  CudaMatrix info = scratch(1, 1);
+  // The arguments are valid, the status is not read
+  cusolverDnDgeqrf(_solver_handle, int(n), int(candidates), factor.data(),
+                   int(n), tau.data(), work.data(), lwork,
+                   reinterpret_cast<int *>(info.data()));
+  checkCuda(cudaMemcpy2DAsync(lengths.data() + candidates, sizeof(double),
+                              factor.data(), (n + 1) * sizeof(double),
+                              sizeof(double), candidates,
+                              cudaMemcpyDeviceToDevice, _stream));
+  Eigen::VectorXd host_lengths = Eigen::MatrixXd(lengths);
+
+  // Move the independent candidates first and orthonormalize them
+  Index kept = 0;
+  for (Index j = 0; j < candidates; j++) {
+    if (std::abs(host_lengths(candidates + j)) <=
+        min_new_direction * host_lengths(j)) {
+      continue;
+    }
+    if (j != kept) {
+      checkCuda(cudaMemcpyAsync(W.data() + kept * n, W.data() + j * n,
+                                n * sizeof(double), cudaMemcpyDeviceToDevice,
+                                _stream));
+    }
+    kept++;
+  }
+  if (kept > 0) {
+    CudaMatrix independent = V.middle_cols(m, kept);
+    orthonormalize(independent);
+  }
+  return kept;
+}
+
+}  // namespace eigencuda
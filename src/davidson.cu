@@ -0,0 +1,71 @@
+#include "cudakernels.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+// Smallest magnitude of the denominators of the preconditioner
+constexpr double min_denominator = 1e-8;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+__global__ void ritz_residuals_kernel(const double *X, const double *AX,
+                                      const double *theta, Index rows,
+                                      Index size, double *R) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    R[i] = AX[i] - theta[i / rows] * X[i];
+  }
+}
+
+__global__ void davidson_correction_kernel(const double *R,
+                                           const double *diagonal,
+                                           const double *theta, Index rows,
+                                           Index size, double *T) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    double denominator = theta[i / rows] - diagonal[i % rows];
+    if (fabs(denominator) < min_denominator) {
+      denominator = copysign(min_denominator, denominator);
+    }
+    T[i] = R[i] / denominator;
+  }
+}
+}  // namespace
+
+cudaError_t ritz_residuals(const double *X, const double *AX,
+                           const double *theta, Index rows, Index cols,
+                           double *R, cudaStream_t stream) {
+  Index size = rows * cols;
+  if (size == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks(size);
+  ritz_residuals_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      X, AX, theta, rows, size, R);
+  return cudaGetLastError();
+}
+
+cudaError_t davidson_correction(const double *R, const double *diagonal,
+                                const double *theta, Index rows, Index cols,
+                                double *T, cudaStream_t stream) {
+  Index size = rows * cols;
+  if (size == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks(size);
+  davidson_correction_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      R, diagonal, theta, rows, size, T);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
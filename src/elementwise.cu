@@ -0,0 +1,104 @@
+#include "cudakernels.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+struct Multiply {
+  __device__ double operator()(double a, double b) const { return a * b; }
+};
+struct Divide {
+  __device__ double operator()(double a, double b) const { return a / b; }
+};
+
+struct Abs {
+  __device__ double operator()(double a) const { return fabs(a); }
+};
+struct Exp {
+  __device__ double operator()(double a) const { return exp(a); }
+};
+struct Log {
+  __device__ double operator()(double a) const { return log(a); }
+};
+struct Sqrt {
+  __device__ double operator()(double a) const { return sqrt(a); }
+};
+struct Square {
+  __device__ double operator()(double a) const { return a * a; }
+};
+struct Reciprocal {
+  __device__ double operator()(double a) const { return 1. / a; }
+};
+
+// Grid-stride loops, any launch configuration covers the whole array
+template <typename F>
+__global__ void binary_kernel(const double *A, const double *B, double *C,
+                              Index size, F f) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    C[i] = f(A[i], B[i]);
+  }
+}
+
+template <typename F>
+__global__ void unary_kernel(double *A, Index size, F f) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    A[i] = f(A[i]);
+  }
+}
+
+template <typename F>
+cudaError_t launch_unary(double *A, Index size, cudaStream_t stream, F f) {
+  unary_kernel<<<number_of_blocks(size), threads_per_block, 0, stream>>>(
+      A, size, f);
+  return cudaGetLastError();
+}
+}  // namespace
+
+cudaError_t hadamard_product(const double *A, const double *B, double *C,
+                             Index size, cudaStream_t stream) {
+  binary_kernel<<<number_of_blocks(size), threads_per_block, 0, stream>>>(
+      A, B, C, size, Multiply{});
+  return cudaGetLastError();
+}
+
+cudaError_t hadamard_division(const double *A, const double *B, double *C,
+                              Index size, cudaStream_t stream) {
+  binary_kernel<<<number_of_blocks(size), threads_per_block, 0, stream>>>(
+      A, B, C, size, Divide{});
+  return cudaGetLastError();
+}
+
+cudaError_t apply(double *A, Index size, UnaryFunction function,
+                  cudaStream_t stream) {
+  switch (function) {
+    case UnaryFunction::Abs:
+      return launch_unary(A, size, stream, Abs{});
+    case UnaryFunction::Exp:
+      return launch_unary(A, size, stream, Exp{});
+    case UnaryFunction::Log:
+      return launch_unary(A, size, stream, Log{});
+    case UnaryFunction::Sqrt:
+      return launch_unary(A, size, stream, Sqrt{});
+    case UnaryFunction::Square:
+      return launch_unary(A, size, stream, Square{});
+    case UnaryFunction::Reciprocal:
+      return launch_unary(A, size, stream, Reciprocal{});
+  }
+  return cudaErrorInvalidValue;
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
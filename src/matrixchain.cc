@@ -0,0 +1,142 @@
+#include "matrixchain.hpp"
+#include <algorithm>
+
+namespace eigencuda {
+
+ChainPlan::ChainPlan(const std::vector<Index> &dims) : _dims{dims} {
+  if (dims.size() < 2) {
+    throw std::runtime_error("Empty matrix chain");
+  }
+  int n = int(length());
+  for (int i = 0; i < n; i++) {
+    _slot_sizes.push_back(dims[i] * dims[i + 1]);
+    _free.push_back(false);
+  }
+
+  // costs[i][j] is the best product of the operands i to j. The left factor
+  // is computed first and stays alive while the right one is computed
+  std::vector<std::vector<Cost>> costs(n, std::vector<Cost>(n, Cost{0, 0, -1}));
+  for (int span = 1; span < n; span++) {
+    for (int i = 0; i + span < n; i++) {
+      int j = i + span;
+      Index output = dims[i] * dims[j + 1];
+      Cost &best = costs[i][j];
+      best.split = -1;
+      for (int s = i; s < j; s++) {
+        const Cost &left = costs[i][s];
+        const Cost &right = costs[s + 1][j];
+        Index left_size = (s > i) ? dims[i] * dims[s + 1] : 0;
+        Index right_size = (s + 1 < j) ? dims[s + 1] * dims[j + 1] : 0;
+        double flops = left.flops + right.flops +
+                       2. * double(dims[i]) * double(dims[s + 1]) *
+                           double(dims[j + 1]);
+        Index peak = std::max({left.peak, left_size + right.peak,
+                               left_size + right_size + output});
+        if (best.split < 0 || flops < best.flops ||
+            (flops == best.flops && peak < best.peak)) {
+          best = Cost{flops, peak, s};
+        }
+      }
+    }
+  }
+  _flops = costs[0][n - 1].flops;
+  _peak_memory = (n > 1) ? costs[0][n - 1].peak : 0;
+  _parenthesization = order(0, n - 1, costs);
+
+  if (n > 1) {
+    emit(0, n - 1, costs, true);
+  } else {
+    // A single operand is copied into the result
+    _slot_sizes.push_back(_slot_sizes.front());
+  }
+}
+
+std::string ChainPlan::order(
+    int i, int j, const std::vector<std::vector<Cost>> &costs) const {
+  if (i == j) {
+    return std::to_string(i);
+  }
+  int s = costs[i][j].split;
+  return "(" + order(i, s, costs) + " " + order(s + 1, j, costs) + ")";
+}
+
+int ChainPlan::emit(int i, int j, const std::vector<std::vector<Cost>> &costs,
+                    bool last) {
+  if (i == j) {
+    return i;
+  }
+  int s = costs[i][j].split;
+  ChainStep step;
+  step.left = emit(i, s, costs, false);
+  step.right = emit(s + 1, j, costs, false);
+  step.m = _dims[i];
+  step.n = _dims[j + 1];
+  step.k = _dims[s + 1];
+  if (last) {
+    _slot_sizes.push_back(step.m * step.n);
+    _free.push_back(false);
+    step.output = result_slot();
+  } else {
+    // The output is acquired before releasing the factors, it cannot alias
+    // them
+    step.output = acquire(step.m * step.n);
+  }
+  release(step.left);
+  release(step.right);
+  _steps.push_back(step);
+  return step.output;
+}
+
+int ChainPlan::acquire(Index size) {
+  // The smallest free slot that fits, or else the largest one grown
+  int fitting = -1;
+  int largest = -1;
+  for (int slot = int(length()); slot < int(_slot_sizes.size()); slot++) {
+    if (!_free[slot]) {
+      continue;
+    }
+    Index capacity = _slot_sizes[slot];
+    if (capacity >= size &&
+        (fitting < 0 || capacity < _slot_sizes[fitting])) {
+      fitting = slot;
+    }
+    if (largest < 0 || capacity > _slot_sizes[largest]) {
+      largest = slot;
+    }
+  }
+  int slot = (fitting >= 0) ? fitting : largest;
+  if (slot < 0) {
+    _slot_sizes.push_back(size);
+    _free.push_back(false);
+    return int(_slot_sizes.size()) - 1;
+  }
+  _slot_sizes[slot] = std::max(_slot_sizes[slot], size);
+  _free[slot] = false;
+  return slot;
+}
+
+void ChainPlan::release(int slot) {
+  // The operands are never recycled
+  if (slot >= int(length())) {
+    _free[slot] = true;
+  }
+}
+
+void ChainPlan::throw_if_incompatible(const std::vector<Index> &dims) const {
+  if (dims != _dims) {
+    throw std::runtime_error(
+        "The operands do not have the shapes of the matrix chain plan");
+  }
+}
+
+std::ostream &operator<<(std::ostream &os, const ChainPlan &plan) {
+  os << plan.parenthesization() << ": " << plan.flops() << " flops, "
+     << plan.peak_memory() << " elements of temporaries\n";
+  for (const ChainStep &step : plan.steps()) {
+    os << "  gemm " << step.left << " * " << step.right << " (" << step.m
+       << " x " << step.n << " x " << step.k << ") -> " << step.output << "\n";
+  }
+  return os;
+}
+
+}  // namespace eigencuda
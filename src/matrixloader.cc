@@ -0,0 +1,74 @@
+#include "matrixloader.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace eigencuda {
+
+namespace {
+// Read-only memory map of a whole file, unmapped when going out of scope
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open file: " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      throw std::runtime_error("Cannot stat file: " + filename);
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size > 0) {
+      _data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (_data == MAP_FAILED) {
+      throw std::runtime_error("Cannot memory map file: " + filename);
+    }
+    if (_data) {
+      // The file is read once from start to end
+      madvise(_data, _size, MADV_SEQUENTIAL);
+      madvise(_data, _size, MADV_WILLNEED);
+    }
+  }
+  ~MappedFile() {
+    if (_data && _data != MAP_FAILED) {
+      munmap(_data, _size);
+    }
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const void *data() const { return _data; };
+  size_t size() const { return _size; };
+
+ private:
+  void *_data = nullptr;
+  size_t _size = 0;
+};
+}  // namespace
+
+CudaMatrix load_matrix(const std::string &filename, Index nrows, Index ncols,
+                       CudaPipeline &pipeline) {
+  MappedFile file{filename};
+  size_t expected = nrows * ncols * sizeof(double);
+  if (file.size() != expected) {
+    std::ostringstream oss;
+    oss << "File " << filename << " has " << file.size()
+        << " bytes but a matrix of shape (" << nrows << ", " << ncols
+        << ") requires " << expected << " bytes\n";
+    throw std::runtime_error(oss.str());
+  }
+
+  CudaMatrix matrix{nrows, ncols, pipeline.get_stream()};
+  pipeline.staging().upload(matrix.data(), file.data(), expected,
+                            pipeline.get_stream());
+  return matrix;
+}
+
+}  // namespace eigencuda
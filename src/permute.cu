@@ -0,0 +1,67 @@
+#include "cudakernels.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+constexpr int max_rank = 8;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+// Passed by value, the kernel reads it from the constant parameter space
+struct Layout {
+  int rank;
+  Index dims[max_rank];     // dimensions of the output
+  Index strides[max_rank];  // input stride of every output dimension
+};
+
+// Every thread writes consecutive outputs, so the stores are coalesced
+__global__ void permute_kernel(const double *A, double *B, Index size,
+                               Layout layout) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    Index rest = i;
+    Index offset = 0;
+    for (int d = 0; d < layout.rank; d++) {
+      offset += (rest % layout.dims[d]) * layout.strides[d];
+      rest /= layout.dims[d];
+    }
+    B[i] = A[offset];
+  }
+}
+}  // namespace
+
+cudaError_t permute(const double *A, const Index *dims, const int *permutation,
+                    int rank, double *B, cudaStream_t stream) {
+  if (rank > max_rank) {
+    return cudaErrorInvalidValue;
+  }
+  Index input_strides[max_rank];
+  Index size = 1;
+  for (int d = 0; d < rank; d++) {
+    input_strides[d] = size;
+    size *= dims[d];
+  }
+  Layout layout;
+  layout.rank = rank;
+  for (int d = 0; d < rank; d++) {
+    layout.dims[d] = dims[permutation[d]];
+    layout.strides[d] = input_strides[permutation[d]];
+  }
+  if (size == 0) {
+    return cudaSuccess;
+  }
+  permute_kernel<<<number_of_blocks(size), threads_per_block, 0, stream>>>(
+      A, B, size, layout);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
@@ -0,0 +1,91 @@
+#ifndef PHILOX_H_
+#define PHILOX_H_
+
+#include <cmath>
+#include <cstdint>
+
+/*
+ * \brief Counter based random numbers shared by the host and the device
+ *
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+ * 3", SC 2011) maps a 128 bit counter and a 64 bit key to 128 random bits.
+ * Every block of the sequence (seed, subsequence) is computed independently,
+ * so the kernels and the host loops produce the same numbers in any order.
+ */
+
+#ifdef __CUDACC__
+#define PHILOX_QUALIFIERS __host__ __device__ inline
+#else
+#define PHILOX_QUALIFIERS inline
+#endif
+
+namespace eigencuda {
+namespace philox {
+
+struct Block {
+  std::uint32_t word[4];
+};
+
+PHILOX_QUALIFIERS Block philox4x32(std::uint64_t counter_low,
+                                   std::uint64_t counter_high,
+                                   std::uint64_t key) {
+  const std::uint32_t M0 = 0xD2511F53;
+  const std::uint32_t M1 = 0xCD9E8D57;
+  const std::uint32_t W0 = 0x9E3779B9;
+  const std::uint32_t W1 = 0xBB67AE85;
+  std::uint32_t c[4] = {std::uint32_t(counter_low),
+                        std::uint32_t(counter_low >> 32),
+                        std::uint32_t(counter_high),
+                        std::uint32_t(counter_high >> 32)};
+  std::uint32_t k[2] = {std::uint32_t(key), std::uint32_t(key >> 32)};
+  for (int round = 0; round < 10; round++) {
+    std::uint64_t product0 = std::uint64_t(M0) * c[0];
+    std::uint64_t product1 = std::uint64_t(M1) * c[2];
+    std::uint32_t next[4] = {
+        std::uint32_t(product1 >> 32) ^ c[1] ^ k[0], std::uint32_t(product1),
+        std::uint32_t(product0 >> 32) ^ c[3] ^ k[1], std::uint32_t(product0)};
+    for (int i = 0; i < 4; i++) {
+      c[i] = next[i];
+    }
+    k[0] += W0;
+    k[1] += W1;
+  }
+  return Block{{c[0], c[1], c[2], c[3]}};
+}
+
+// Double in (0, 1) from the 53 high bits of x, never exactly 0 or 1
+PHILOX_QUALIFIERS double to_uniform(std::uint32_t high, std::uint32_t low) {
+  std::uint64_t x = (std::uint64_t(high) << 32) | low;
+  return (double(x >> 11) + 0.5) * (1. / 9007199254740992.);
+}
+
+// Elements 2 * index and 2 * index + 1 of the sequence (seed, subsequence).
+// Uniform numbers lie in (0, 1), normal ones use the Box-Muller transform
+PHILOX_QUALIFIERS void uniform_pair(std::uint64_t seed,
+                                    std::uint64_t subsequence,
+                                    std::uint64_t index, double &u0,
+                                    double &u1) {
+  Block block = philox4x32(index, subsequence, seed);
+  u0 = to_uniform(block.word[0], block.word[1]);
+  u1 = to_uniform(block.word[2], block.word[3]);
+}
+
+PHILOX_QUALIFIERS void normal_pair(std::uint64_t seed,
+                                   std::uint64_t subsequence,
+                                   std::uint64_t index, double &z0,
+                                   double &z1) {
+  const double two_pi = 6.283185307179586;
+  double u0;
+  double u1;
+  uniform_pair(seed, subsequence, index, u0, u1);
+  double radius = std::sqrt(-2. * std::log(u0));
+  z0 = radius * std::cos(two_pi * u1);
+  z1 = radius * std::sin(two_pi * u1);
+}
+
+}  // namespace philox
+}  // namespace eigencuda
+
+#undef PHILOX_QUALIFIERS
+
+#endif  // PHILOX_H_
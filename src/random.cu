@@ -0,0 +1,52 @@
+#include "cudakernels.hpp"
+#include "philox.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+// Every thread writes the pair of numbers of a Philox block
+__global__ void random_kernel(double *A, Index size, Distribution distribution,
+                              std::uint64_t seed, std::uint64_t subsequence) {
+  Index pairs = (size + 1) / 2;
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < pairs;
+       i += stride) {
+    double x0;
+    double x1;
+    if (distribution == Distribution::Normal) {
+      philox::normal_pair(seed, subsequence, i, x0, x1);
+    } else {
+      philox::uniform_pair(seed, subsequence, i, x0, x1);
+    }
+    A[2 * i] = x0;
+    if (2 * i + 1 < size) {
+      A[2 * i + 1] = x1;
+    }
+  }
+}
+}  // namespace
+
+cudaError_t random(double *A, Index size, Distribution distribution,
+                   std::uint64_t seed, std::uint64_t subsequence,
+                   cudaStream_t stream) {
+  if (size == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks((size + 1) / 2);
+  random_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      A, size, distribution, seed, subsequence);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
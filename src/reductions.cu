@@ -0,0 +1,116 @@
+#include "cudakernels.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+// Power of two, required by the tree reductions
+constexpr int threads_per_block = 256;
+constexpr int max_partials = 256;
+
+struct Sum {
+  __device__ double transform(double a) const { return a; }
+  __device__ double combine(double a, double b) const { return a + b; }
+};
+struct AbsMax {
+  __device__ double transform(double a) const { return fabs(a); }
+  __device__ double combine(double a, double b) const { return a > b ? a : b; }
+};
+struct SquareSum {
+  __device__ double transform(double a) const { return a * a; }
+  __device__ double combine(double a, double b) const { return a + b; }
+};
+
+// Reduce the block values stored in cache. The order of the operations only
+// depends on the launch configuration, so the results are reproducible
+template <typename Op>
+__device__ double block_reduce(double *cache, double value, Op op) {
+  cache[threadIdx.x] = value;
+  __syncthreads();
+  for (unsigned s = blockDim.x / 2; s > 0; s >>= 1) {
+    if (threadIdx.x < s) {
+      cache[threadIdx.x] =
+          op.combine(cache[threadIdx.x], cache[threadIdx.x + s]);
+    }
+    __syncthreads();
+  }
+  return cache[0];
+}
+
+// Each block reduces a strided slice of A into partials[blockIdx.x]
+template <typename Op>
+__global__ void reduce_kernel(const double *A, Index size, Index stride,
+                              double *partials, Op op) {
+  __shared__ double cache[threads_per_block];
+  double value = 0.;
+  Index step = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += step) {
+    value = op.combine(value, op.transform(A[i * stride]));
+  }
+  double result = block_reduce(cache, value, op);
+  if (threadIdx.x == 0) {
+    partials[blockIdx.x] = result;
+  }
+}
+
+// Every block computes the norm of whole columns
+__global__ void column_norms_kernel(const double *A, Index rows, Index cols,
+                                    double *norms) {
+  __shared__ double cache[threads_per_block];
+  for (Index col = blockIdx.x; col < cols; col += gridDim.x) {
+    const double *column = A + col * rows;
+    double value = 0.;
+    for (Index i = threadIdx.x; i < rows; i += blockDim.x) {
+      value += column[i] * column[i];
+    }
+    double result = block_reduce(cache, value, SquareSum{});
+    if (threadIdx.x == 0) {
+      norms[col] = sqrt(result);
+    }
+    __syncthreads();
+  }
+}
+
+int number_of_partials(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_partials ? blocks : max_partials);
+}
+
+// Two passes: blocks into partials, then partials into result
+template <typename Op>
+cudaError_t reduce(const double *A, Index size, Index stride, double *buffer,
+                   double *result, cudaStream_t stream, Op op) {
+  int partials = number_of_partials(size);
+  reduce_kernel<<<partials, threads_per_block, 0, stream>>>(A, size, stride,
+                                                            buffer, op);
+  reduce_kernel<<<1, threads_per_block, 0, stream>>>(buffer, partials, 1,
+                                                     result, op);
+  return cudaGetLastError();
+}
+}  // namespace
+
+Index reduction_buffer_size() { return max_partials; }
+
+cudaError_t sum(const double *A, Index size, Index stride, double *buffer,
+                double *result, cudaStream_t stream) {
+  return reduce(A, size, stride, buffer, result, stream, Sum{});
+}
+
+cudaError_t max_abs(const double *A, Index size, double *buffer,
+                    double *result, cudaStream_t stream) {
+  return reduce(A, size, 1, buffer, result, stream, AbsMax{});
+}
+
+cudaError_t column_norms(const double *A, Index rows, Index cols,
+                         double *norms, cudaStream_t stream) {
+  int blocks = static_cast<int>(cols < max_partials ? cols : max_partials);
+  blocks = blocks < 1 ? 1 : blocks;
+  column_norms_kernel<<<blocks, threads_per_block, 0, stream>>>(A, rows, cols,
+                                                                norms);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
@@ -0,0 +1,149 @@
+#include "cudakernels.hpp"
+#include <type_traits>
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+constexpr int warp_size = 32;
+// Up to this size every thread multiplies a whole pair in registers
+constexpr int max_register_size = 4;
+
+int number_of_blocks(Index size, int threads) {
+  Index blocks = (size + threads - 1) / threads;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+// Products held by a block of the shared memory kernel, so that every thread
+// computes about one element of the results
+template <int N>
+constexpr int products_per_block() {
+  return N * N >= threads_per_block ? 1 : threads_per_block / (N * N);
+}
+
+// One thread per product, the operands are loaded into registers and the
+// fully known loops are unrolled by the compiler
+template <int N>
+__global__ void register_gemm_kernel(const double *A, const double *B,
+                                     double *C, Index batch) {
+  constexpr int elements = N * N;
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index p = Index(blockIdx.x) * blockDim.x + threadIdx.x; p < batch;
+       p += stride) {
+    double a[elements];
+    double b[elements];
+    for (int e = 0; e < elements; e++) {
+      a[e] = A[p * elements + e];
+      b[e] = B[p * elements + e];
+    }
+    for (int j = 0; j < N; j++) {
+      for (int i = 0; i < N; i++) {
+        double value = 0.;
+        for (int k = 0; k < N; k++) {
+          value += a[i + k * N] * b[k + j * N];
+        }
+        C[p * elements + i + j * N] = value;
+      }
+    }
+  }
+}
+
+// Every block stages a group of consecutive pairs in shared memory with
+// coalesced loads, then each thread computes elements of the products
+template <int N>
+__global__ void shared_gemm_kernel(const double *A, const double *B,
+                                   double *C, Index batch) {
+  constexpr int elements = N * N;
+  constexpr int products = products_per_block<N>();
+  __shared__ double tile_A[products * elements];
+  __shared__ double tile_B[products * elements];
+  for (Index first = Index(blockIdx.x) * products; first < batch;
+       first += Index(gridDim.x) * products) {
+    Index count = (batch - first < products) ? batch - first : products;
+    Index offset = first * elements;
+    Index size = count * elements;
+    for (Index e = threadIdx.x; e < size; e += blockDim.x) {
+      tile_A[e] = A[offset + e];
+      tile_B[e] = B[offset + e];
+    }
+    __syncthreads();
+    for (Index e = threadIdx.x; e < size; e += blockDim.x) {
+      int local = int(e % elements);
+      const double *a = tile_A + (e - local) + local % N;
+      const double *b = tile_B + (e - local) + (local / N) * N;
+      double value = 0.;
+      for (int k = 0; k < N; k++) {
+        value += a[k * N] * b[k];
+      }
+      C[offset + e] = value;
+    }
+    __syncthreads();
+  }
+}
+
+// One thread per product for the smallest sizes
+template <int N>
+cudaError_t launch_small_gemm(const double *A, const double *B, double *C,
+                              Index batch, cudaStream_t stream,
+                              std::true_type) {
+  int blocks = number_of_blocks(batch, threads_per_block);
+  register_gemm_kernel<N><<<blocks, threads_per_block, 0, stream>>>(A, B, C,
+                                                                    batch);
+  return cudaGetLastError();
+}
+
+template <int N>
+cudaError_t launch_small_gemm(const double *A, const double *B, double *C,
+                              Index batch, cudaStream_t stream,
+                              std::false_type) {
+  constexpr int products = products_per_block<N>();
+  // Round the threads of a group up to whole warps
+  constexpr int group = products * N * N;
+  constexpr int threads =
+      (group < threads_per_block)
+          ? (group + warp_size - 1) / warp_size * warp_size
+          : threads_per_block;
+  int blocks = number_of_blocks((batch + products - 1) / products, 1);
+  shared_gemm_kernel<N><<<blocks, threads, 0, stream>>>(A, B, C, batch);
+  return cudaGetLastError();
+}
+
+// Map the runtime size to the kernel specialized for it
+template <int N>
+struct SmallGemm {
+  static cudaError_t launch(int n, const double *A, const double *B,
+                            double *C, Index batch, cudaStream_t stream) {
+    if (n == N) {
+      return launch_small_gemm<N>(
+          A, B, C, batch, stream,
+          std::integral_constant<bool, (N <= max_register_size)>{});
+    }
+    return SmallGemm<N - 1>::launch(n, A, B, C, batch, stream);
+  }
+};
+
+template <>
+struct SmallGemm<0> {
+  static cudaError_t launch(int, const double *, const double *, double *,
+                            Index, cudaStream_t) {
+    return cudaErrorInvalidValue;
+  }
+};
+}  // namespace
+
+cudaError_t small_gemm(const double *A, const double *B, double *C, int n,
+                       Index batch, cudaStream_t stream) {
+  if (n < 1 || n > max_small_size) {
+    return cudaErrorInvalidValue;
+  }
+  if (batch == 0) {
+    return cudaSuccess;
+  }
+  return SmallGemm<max_small_size>::launch(n, A, B, C, batch, stream);
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
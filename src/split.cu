@@ -0,0 +1,102 @@
+#include "cudakernels.hpp"
+#include "split.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+// One thread per row (or column) of the column major matrix
+__global__ void split_scales_kernel(const double *A, Index rows, Index cols,
+                                    bool by_rows, double *scales) {
+  Index count = by_rows ? rows : cols;
+  Index length = by_rows ? cols : rows;
+  Index step = by_rows ? rows : 1;
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < count;
+       i += stride) {
+    const double *first = by_rows ? A + i : A + i * rows;
+    double max_abs = 0.;
+    for (Index j = 0; j < length; j++) {
+      max_abs = fmax(max_abs, fabs(first[j * step]));
+    }
+    scales[i] = split::scale_of(max_abs);
+  }
+}
+
+__global__ void split_slices_kernel(const double *A, Index rows, Index size,
+                                    const double *scales, bool by_rows,
+                                    int width, int slices, float *output) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    double x = A[i] / scales[by_rows ? i % rows : i / rows];
+    for (int level = 0; level < slices; level++) {
+      output[level * size + i] = split::extract_slice(x, level, width);
+    }
+  }
+}
+
+__global__ void accumulate_split_kernel(const float *P,
+                                        const double *row_scales,
+                                        const double *col_scales, Index rows,
+                                        Index size, double *C,
+                                        bool overwrite) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index i = Index(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+       i += stride) {
+    // The scaled product is exact, only the sum rounds
+    double value = row_scales[i % rows] * col_scales[i / rows] * double(P[i]);
+    C[i] = overwrite ? value : C[i] + value;
+  }
+}
+}  // namespace
+
+cudaError_t split_scales(const double *A, Index rows, Index cols,
+                         bool by_rows, double *scales, cudaStream_t stream) {
+  Index count = by_rows ? rows : cols;
+  if (count == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks(count);
+  split_scales_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      A, rows, cols, by_rows, scales);
+  return cudaGetLastError();
+}
+
+cudaError_t split_slices(const double *A, Index rows, Index cols,
+                         const double *scales, bool by_rows, int width,
+                         int slices, float *output, cudaStream_t stream) {
+  Index size = rows * cols;
+  if (size == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks(size);
+  split_slices_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      A, rows, size, scales, by_rows, width, slices, output);
+  return cudaGetLastError();
+}
+
+cudaError_t accumulate_split(const float *P, const double *row_scales,
+                             const double *col_scales, Index rows, Index cols,
+                             double *C, bool overwrite, cudaStream_t stream) {
+  Index size = rows * cols;
+  if (size == 0) {
+    return cudaSuccess;
+  }
+  int blocks = number_of_blocks(size);
+  accumulate_split_kernel<<<blocks, threads_per_block, 0, stream>>>(
+      P, row_scales, col_scales, rows, size, C, overwrite);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
@@ -0,0 +1,77 @@
+#ifndef SPLIT_H_
+#define SPLIT_H_
+
+#include <cmath>
+#include <cstddef>
+
+/*
+ * \brief Error-free splitting of doubles into single precision slices
+ *
+ * Ozaki, Ogita, Oishi and Rump, "Error-free transformations of matrix
+ * multiplication by using fast routines of matrix multiplication and its
+ * applications", Numer. Algorithms 59 (2012). Every row of A and column of B
+ * is scaled by a power of two into (-1, 1) and cut into slices of `width`
+ * bits, slice l being a multiple of 2^-((l + 1) * width). The width is small
+ * enough for the product of two slices to be exact in single precision, so
+ * the kernels and the host loops give the same slices and the same products.
+ */
+
+#ifdef __CUDACC__
+#define SPLIT_QUALIFIERS __host__ __device__ inline
+#else
+#define SPLIT_QUALIFIERS inline
+#endif
+
+namespace eigencuda {
+namespace split {
+
+// Significand bits of single precision and of the inputs of the TF32 tensor
+// cores, which accumulate in single precision
+constexpr int float_bits = 24;
+constexpr int tf32_bits = 11;
+
+inline int ceil_log2(std::ptrdiff_t k) {
+  int log_k = 0;
+  while ((std::ptrdiff_t(1) << log_k) < k) {
+    log_k++;
+  }
+  return log_k;
+}
+
+// Width of the slices such that the sum of k products of two slices is
+// exact in single precision, 2 * width + ceil(log2(k)) <= 24, and that the
+// slices fit in the inputs of the products
+inline int slice_width(std::ptrdiff_t k, int input_bits) {
+  int width = (float_bits - ceil_log2(k)) / 2;
+  return width < input_bits ? width : input_bits;
+}
+
+// Slices needed for an error of about 2^-bits times the scales of the row
+// of A and the column of B, the growth with the k terms included
+inline int number_of_slices(int bits, std::ptrdiff_t k, int width) {
+  return (bits + ceil_log2(k) + width - 1) / width;
+}
+
+// Power of two strictly above max_abs, 1 for zero
+SPLIT_QUALIFIERS double scale_of(double max_abs) {
+  if (max_abs == 0.) {
+    return 1.;
+  }
+  int exponent;
+  frexp(max_abs, &exponent);
+  return ldexp(1., exponent);
+}
+
+// Remove slice `level` from x, |x| < 2^-(level * width), and return it.
+// Adding and subtracting sigma rounds x to a multiple of the ulp of sigma
+SPLIT_QUALIFIERS float extract_slice(double &x, int level, int width) {
+  double sigma = ldexp(1.5, 52 - (level + 1) * width);
+  double slice = (x + sigma) - sigma;
+  x -= slice;
+  return float(slice);
+}
+
+}  // namespace split
+}  // namespace eigencuda
+
+#endif  // SPLIT_H_
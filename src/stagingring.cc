@@ -0,0 +1,85 @@
+#include "stagingring.hpp"
+#include <cstring>
+
+namespace eigencuda {
+
+StagingRing::StagingRing(size_t nchunks, size_t chunk_bytes)
+    : _chunks(nchunks), _chunk_bytes{chunk_bytes} {
+  if (nchunks < 2 || chunk_bytes == 0) {
+    throw std::runtime_error(
+        "A staging ring needs at least two non empty chunks");
+  }
+  for (Chunk &chunk : _chunks) {
+    if (checkCuda(cudaMallocHost(&chunk.buffer, chunk_bytes)) != cudaSuccess) {
+      release();
+      throw std::runtime_error("Could not allocate pinned staging memory");
+    }
+    checkCuda(cudaEventCreateWithFlags(&chunk.done, cudaEventDisableTiming));
+  }
+}
+
+StagingRing::~StagingRing() { release(); }
+
+void StagingRing::release() {
+  for (Chunk &chunk : _chunks) {
+    if (chunk.done) {
+      wait(chunk);
+      checkCuda(cudaEventDestroy(chunk.done));
+      chunk.done = nullptr;
+    }
+    if (chunk.buffer) {
+      checkCuda(cudaFreeHost(chunk.buffer));
+      chunk.buffer = nullptr;
+    }
+  }
+}
+
+void StagingRing::wait(Chunk &chunk) {
+  checkCuda(cudaEventSynchronize(chunk.done));
+  if (chunk.pending_bytes > 0) {
+    std::memcpy(chunk.host_dst, chunk.buffer, chunk.pending_bytes);
+    chunk.host_dst = nullptr;
+    chunk.pending_bytes = 0;
+  }
+}
+
+void StagingRing::upload(void *device_dst, const void *host_src, size_t bytes,
+                         const cudaStream_t &stream) {
+  char *dst = static_cast<char *>(device_dst);
+  const char *src = static_cast<const char *>(host_src);
+  for (size_t offset = 0; offset < bytes; offset += _chunk_bytes) {
+    size_t len = std::min(_chunk_bytes, bytes - offset);
+    Chunk &chunk = _chunks[_next];
+    _next = (_next + 1) % _chunks.size();
+
+    wait(chunk);
+    std::memcpy(chunk.buffer, src + offset, len);
+    checkCuda(cudaMemcpyAsync(dst + offset, chunk.buffer, len,
+                              cudaMemcpyHostToDevice, stream));
+    checkCuda(cudaEventRecord(chunk.done, stream));
+  }
+}
+
+void StagingRing::download(void *host_dst, const void *device_src,
+                           size_t bytes, const cudaStream_t &stream) {
+  char *dst = static_cast<char *>(host_dst);
+  const char *src = static_cast<const char *>(device_src);
+  for (size_t offset = 0; offset < bytes; offset += _chunk_bytes) {
+    size_t len = std::min(_chunk_bytes, bytes - offset);
+    Chunk &chunk = _chunks[_next];
+    _next = (_next + 1) % _chunks.size();
+
+    wait(chunk);
+    checkCuda(cudaMemcpyAsync(chunk.buffer, src + offset, len,
+                              cudaMemcpyDeviceToHost, stream));
+    checkCuda(cudaEventRecord(chunk.done, stream));
+    chunk.host_dst = dst + offset;
+    chunk.pending_bytes = len;
+  }
+  // Deliver the chunks still in flight, oldest first
+  for (size_t i = 0; i < _chunks.size(); i++) {
+    wait(_chunks[(_next + i) % _chunks.size()]);
+  }
+}
+
+}  // namespace eigencuda
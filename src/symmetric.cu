@@ -0,0 +1,62 @@
+#include "cudakernels.hpp"
+
+namespace eigencuda {
+namespace kernels {
+
+namespace {
+constexpr int threads_per_block = 256;
+constexpr Index max_blocks = 1024;
+
+int number_of_blocks(Index size) {
+  Index blocks = (size + threads_per_block - 1) / threads_per_block;
+  blocks = blocks < 1 ? 1 : blocks;
+  return static_cast<int>(blocks < max_blocks ? blocks : max_blocks);
+}
+
+// Position of (i, j) in the column-major packed storage of a triangle
+__device__ Index packed_index(Index i, Index j, Index n, bool lower) {
+  return lower ? j * (2 * n - j + 1) / 2 + (i - j) : j * (j + 1) / 2 + i;
+}
+
+__global__ void symmetrize_kernel(double *C, Index n, bool lower) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index k = Index(blockIdx.x) * blockDim.x + threadIdx.x; k < n * n;
+       k += stride) {
+    Index i = k % n;
+    Index j = k / n;
+    // Overwrite the triangle that was not computed with its mirror
+    if ((lower && i < j) || (!lower && i > j)) {
+      C[k] = C[j + i * n];
+    }
+  }
+}
+
+__global__ void pack_kernel(const double *C, Index n, bool lower,
+                            double *packed) {
+  Index stride = Index(blockDim.x) * gridDim.x;
+  for (Index k = Index(blockIdx.x) * blockDim.x + threadIdx.x; k < n * n;
+       k += stride) {
+    Index i = k % n;
+    Index j = k / n;
+    if ((lower && i >= j) || (!lower && i <= j)) {
+      packed[packed_index(i, j, n, lower)] = C[k];
+    }
+  }
+}
+}  // namespace
+
+cudaError_t symmetrize(double *C, Index n, bool lower, cudaStream_t stream) {
+  symmetrize_kernel<<<number_of_blocks(n * n), threads_per_block, 0, stream>>>(
+      C, n, lower);
+  return cudaGetLastError();
+}
+
+cudaError_t pack_triangle(const double *C, Index n, bool lower,
+                          double *packed, cudaStream_t stream) {
+  pack_kernel<<<number_of_blocks(n * n), threads_per_block, 0, stream>>>(
+      C, n, lower, packed);
+  return cudaGetLastError();
+}
+
+}  // namespace kernels
+}  // namespace eigencuda
@@ -0,0 +1,22 @@
+#ifndef TESTS_SIDE_BY_SIDE_H_
+#define TESTS_SIDE_BY_SIDE_H_
+
+#include <Eigen/Core>
+#include <vector>
+
+namespace eigencuda {
+
+// The matrices side by side, the host layout of the batched operations
+inline Eigen::MatrixXd side_by_side(
+    const std::vector<Eigen::MatrixXd> &matrices) {
+  Eigen::Index cols = matrices.front().cols();
+  Eigen::MatrixXd result(matrices.front().rows(), cols * matrices.size());
+  for (std::size_t i = 0; i < matrices.size(); i++) {
+    result.middleCols(i * cols, cols) = matrices[i];
+  }
+  return result;
+}
+
+}  // namespace eigencuda
+
+#endif  // TESTS_SIDE_BY_SIDE_H_
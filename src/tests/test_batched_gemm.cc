@@ -0,0 +1,76 @@
+#define BOOST_TEST_MODULE batched_gemm
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include "cudatensor.hpp"
+#include "side_by_side.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaTensor;
+using eigencuda::Index;
+using eigencuda::side_by_side;
+
+namespace {
+std::vector<Eigen::MatrixXd> random_matrices(Index rows, Index cols,
+                                             Index depth) {
+  std::vector<Eigen::MatrixXd> matrices;
+  for (Index i = 0; i < depth; i++) {
+    matrices.push_back(Eigen::MatrixXd::Random(rows, cols));
+  }
+  return matrices;
+}
+
+void check_products(Index rows, Index inner, Index cols, Index depth) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  std::vector<Eigen::MatrixXd> A = random_matrices(rows, inner, depth);
+  std::vector<Eigen::MatrixXd> B = random_matrices(inner, cols, depth);
+  CudaTensor cuda_A{A, cp.get_stream()};
+  CudaTensor cuda_B{B, cp.get_stream()};
+  CudaTensor cuda_C{1, 1, 1, cp.get_stream()};
+  cp.gemm_batched(cuda_A, cuda_B, cuda_C);
+  std::vector<Eigen::MatrixXd> C = cuda_C;
+
+  Eigen::MatrixXd host_C;
+  cpu.gemm_batched(side_by_side(A), side_by_side(B), host_C, depth);
+
+  BOOST_TEST(C.size() == std::size_t(depth));
+  BOOST_TEST(host_C.rows() == rows);
+  BOOST_TEST(host_C.cols() == cols * depth);
+  for (Index i = 0; i < depth; i++) {
+    Eigen::MatrixXd expected = A[i] * B[i];
+    BOOST_TEST(C[i].isApprox(expected));
+    BOOST_TEST(host_C.middleCols(i * cols, cols).isApprox(expected));
+  }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(small_square_products) {
+  // Register kernels up to 4 x 4 and shared memory ones beyond
+  for (Index n : {1, 2, 3, 4, 5, 7, 8, 12, 16, 17, 31, 32}) {
+    check_products(n, n, n, 300);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(general_products) {
+  // Served by the strided batched gemm of cublas
+  check_products(40, 40, 40, 5);
+  check_products(3, 5, 2, 7);
+}
+
+BOOST_AUTO_TEST_CASE(shape_mismatch) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  CudaTensor A{random_matrices(3, 3, 4), cp.get_stream()};
+  CudaTensor B{random_matrices(3, 3, 5), cp.get_stream()};
+  CudaTensor C{1, 1, 1, cp.get_stream()};
+  BOOST_CHECK_THROW(cp.gemm_batched(A, B, C), std::runtime_error);
+
+  Eigen::MatrixXd host_C;
+  BOOST_CHECK_THROW(cpu.gemm_batched(Eigen::MatrixXd::Random(3, 12),
+                                     Eigen::MatrixXd::Random(3, 15), host_C,
+                                     4),
+                    std::runtime_error);
+}
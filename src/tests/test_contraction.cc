@@ -0,0 +1,203 @@
+#define BOOST_TEST_MODULE contraction
+
+#include "contraction.hpp"
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+#include <map>
+
+using eigencuda::ContractionPlan;
+using eigencuda::ContractionStep;
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaOperand;
+using eigencuda::CudaPipeline;
+using eigencuda::HostOperand;
+using eigencuda::Index;
+using eigencuda::Operation;
+using eigencuda::Shape;
+
+namespace {
+// Sum over every assignment of the indices, the slowest possible einsum
+Eigen::VectorXd reference(const std::vector<std::string> &inputs,
+                          const std::string &output,
+                          const std::vector<Eigen::MatrixXd> &tensors,
+                          const std::vector<Shape> &shapes) {
+  std::map<char, Index> dims;
+  for (std::size_t i = 0; i < inputs.size(); i++) {
+    for (std::size_t d = 0; d < inputs[i].size(); d++) {
+      dims[inputs[i][d]] = shapes[i][d];
+    }
+  }
+  std::string labels;
+  for (const auto &pair : dims) {
+    labels += pair.first;
+  }
+  Index output_size = 1;
+  for (char label : output) {
+    output_size *= dims[label];
+  }
+  Eigen::VectorXd result = Eigen::VectorXd::Zero(output_size);
+
+  std::map<char, Index> index;
+  for (char label : labels) {
+    index[label] = 0;
+  }
+  auto offset = [&](const std::string &tensor_labels) {
+    Index offset = 0;
+    Index stride = 1;
+    for (char label : tensor_labels) {
+      offset += index[label] * stride;
+      stride *= dims[label];
+    }
+    return offset;
+  };
+  while (true) {
+    double product = 1.;
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+      product *= tensors[i].data()[offset(inputs[i])];
+    }
+    result(offset(output)) += product;
+    // Odometer over all the indices
+    std::size_t d = 0;
+    for (; d < labels.size(); d++) {
+      if (++index[labels[d]] < dims[labels[d]]) {
+        break;
+      }
+      index[labels[d]] = 0;
+    }
+    if (d == labels.size()) {
+      break;
+    }
+  }
+  return result;
+}
+
+Eigen::MatrixXd random_tensor(const Shape &shape) {
+  Index rows = shape.empty() ? 1 : shape.front();
+  return Eigen::MatrixXd::Random(rows, eigencuda::shape_size(shape) / rows);
+}
+
+void check_contraction(const std::string &expression,
+                       const std::vector<std::string> &inputs,
+                       const std::string &output,
+                       const std::vector<Shape> &shapes) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  std::vector<Eigen::MatrixXd> tensors;
+  std::vector<CudaMatrix> cuda_tensors;
+  for (const Shape &shape : shapes) {
+    tensors.push_back(random_tensor(shape));
+    cuda_tensors.emplace_back(tensors.back(), cp.get_stream());
+  }
+  std::vector<HostOperand> host_operands;
+  std::vector<CudaOperand> cuda_operands;
+  for (std::size_t i = 0; i < shapes.size(); i++) {
+    host_operands.emplace_back(tensors[i], shapes[i]);
+    cuda_operands.emplace_back(cuda_tensors[i], shapes[i]);
+  }
+
+  Eigen::MatrixXd host_result;
+  cpu.einsum(expression, host_operands, host_result);
+  CudaMatrix cuda_result{1, 1, cp.get_stream()};
+  cp.einsum(expression, cuda_operands, cuda_result);
+  Eigen::MatrixXd device_result = cuda_result;
+
+  Eigen::VectorXd expected = reference(inputs, output, tensors, shapes);
+  Eigen::Map<Eigen::VectorXd> host(host_result.data(), host_result.size());
+  Eigen::Map<Eigen::VectorXd> device(device_result.data(),
+                                     device_result.size());
+  BOOST_TEST(expected.isApprox(host));
+  BOOST_TEST(expected.isApprox(device));
+}
+
+int count_steps(const ContractionPlan &plan, ContractionStep::Kind kind) {
+  int count = 0;
+  for (const ContractionStep &step : plan.steps()) {
+    count += (step.kind == kind);
+  }
+  return count;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(plan_without_permutations) {
+  ContractionPlan plan{"Pij,jk->Pik", {{4, 3, 5}, {5, 6}}};
+  BOOST_TEST(plan.steps().size() == 1);
+  const ContractionStep &gemm = plan.steps().front();
+  BOOST_TEST((gemm.kind == ContractionStep::Kind::Gemm));
+  BOOST_TEST(gemm.m == 12);
+  BOOST_TEST(gemm.n == 6);
+  BOOST_TEST(gemm.k == 5);
+  BOOST_TEST(gemm.batch == 1);
+  BOOST_TEST(plan.flops() == 2. * 12 * 6 * 5);
+  BOOST_TEST(plan.result_rows() == 4);
+  BOOST_TEST(plan.result_cols() == 18);
+
+  // A transposed gemm replaces the permutation of the matrix
+  ContractionPlan transposed{"Pij,kj->Pik", {{4, 3, 5}, {6, 5}}};
+  BOOST_TEST(count_steps(transposed, ContractionStep::Kind::Permute) == 0);
+  BOOST_TEST((transposed.steps().front().op_B == Operation::Transpose));
+
+  // Indices missing from the result are implicit
+  ContractionPlan implicit{"ij,jk", {{2, 3}, {3, 4}}};
+  BOOST_TEST((implicit.result_shape() == Shape{2, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(plan_errors) {
+  BOOST_CHECK_THROW((ContractionPlan{"ii->i", {{3, 3}}}), std::runtime_error);
+  BOOST_CHECK_THROW((ContractionPlan{"ij,jk->ik", {{2, 3}, {4, 5}}}),
+                    std::runtime_error);
+  BOOST_CHECK_THROW((ContractionPlan{"ij,jk->ik", {{2, 3}}}),
+                    std::runtime_error);
+  BOOST_CHECK_THROW((ContractionPlan{"ij->iz", {{2, 3}}}), std::runtime_error);
+  BOOST_CHECK_THROW((ContractionPlan{"i1->i", {{2, 3}}}), std::runtime_error);
+
+  CudaPipeline cp;
+  CudaMatrix A{Eigen::MatrixXd::Random(2, 3), cp.get_stream()};
+  CudaMatrix result{1, 1, cp.get_stream()};
+  ContractionPlan plan{"ij->ji", {{2, 3}}};
+  BOOST_CHECK_THROW(cp.contract(plan, {{A, {3, 2}}}, result),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cp.contract(plan, {{A, {2, 2}}}, result),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(matrix_contractions) {
+  check_contraction("Pij,jk->Pik", {"Pij", "jk"}, "Pik", {{4, 3, 5}, {5, 6}});
+  check_contraction("ijk,kj->i", {"ijk", "kj"}, "i", {{4, 3, 5}, {5, 3}});
+  check_contraction("ij,jk,kl->il", {"ij", "jk", "kl"}, "il",
+                    {{7, 3}, {3, 9}, {9, 2}});
+  check_contraction("i,i->", {"i", "i"}, "", {{10}, {10}});
+}
+
+BOOST_AUTO_TEST_CASE(batched_contractions) {
+  check_contraction("Pij,Pjk->Pik", {"Pij", "Pjk"}, "Pik",
+                    {{4, 3, 5}, {4, 5, 2}});
+  check_contraction("ijP,Qjk->PkiQ", {"ijP", "Qjk"}, "PkiQ",
+                    {{3, 4, 2}, {5, 4, 3}});
+}
+
+BOOST_AUTO_TEST_CASE(single_tensor) {
+  check_contraction("ijk->kji", {"ijk"}, "kji", {{2, 3, 4}});
+  check_contraction("ijk->j", {"ijk"}, "j", {{2, 3, 4}});
+  check_contraction("ij->ij", {"ij"}, "ij", {{5, 4}});
+}
+
+BOOST_AUTO_TEST_CASE(workspace_contractions) {
+  CudaPipeline cp;
+  cp.reserve_workspace(1 << 20);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(6, 4);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(4, 5);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(5, 3);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  CudaMatrix cuma_C{C, cp.get_stream()};
+  CudaMatrix result{1, 1, cp.get_stream()};
+  cp.einsum("ij,jk,kl->il", {{cuma_A, {6, 4}}, {cuma_B, {4, 5}},
+                             {cuma_C, {5, 3}}},
+            result);
+  Eigen::MatrixXd expected = A * B * C;
+  BOOST_TEST(expected.isApprox(Eigen::MatrixXd(result)));
+  BOOST_TEST(cp.workspace().used() == 0);
+  BOOST_TEST(cp.workspace().high_water_mark() > 0);
+}
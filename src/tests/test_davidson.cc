@@ -0,0 +1,137 @@
+#define BOOST_TEST_MODULE davidson
+
+#include "cudapipeline.hpp"
+#include "cudasparse.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaSparseMatrix;
+using eigencuda::DavidsonOptions;
+using eigencuda::DavidsonResult;
+using eigencuda::Index;
+using eigencuda::LinearOperator;
+
+namespace {
+// Symmetric matrix with a growing diagonal and small couplings, the case
+// the diagonal preconditioner is made for
+Eigen::MatrixXd diagonally_dominant(Index n) {
+  Eigen::MatrixXd A = 0.01 * Eigen::MatrixXd::Random(n, n);
+  A = (A + A.transpose()).eval();
+  A.diagonal() = Eigen::VectorXd::LinSpaced(n, 1., double(n));
+  return A;
+}
+
+// The eigenvalues match the reference and the eigenvectors are orthonormal
+// with small residuals
+void check_eigenpairs(const Eigen::MatrixXd &A, const CudaMatrix &values,
+                      const CudaMatrix &vectors, Index count) {
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(A);
+  Eigen::VectorXd lambda = Eigen::MatrixXd(values);
+  Eigen::MatrixXd X = vectors;
+  BOOST_TEST(lambda.isApprox(solver.eigenvalues().head(count), 1e-10));
+  BOOST_TEST(
+      (X.transpose() * X).isApprox(Eigen::MatrixXd::Identity(count, count),
+                                   1e-10));
+  Eigen::MatrixXd residuals = A * X - X * lambda.asDiagonal();
+  BOOST_TEST(residuals.colwise().norm().maxCoeff() < 1e-7);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(dense_davidson) {
+  CudaPipeline cp;
+  cp.reserve_workspace(1 << 24);
+  Index n = 400;
+  Eigen::MatrixXd A = diagonally_dominant(n);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix values{1, 1, cp.get_stream()};
+  CudaMatrix vectors{1, 1, cp.get_stream()};
+  DavidsonResult result = cp.davidson(cuma_A, 10, values, vectors);
+  BOOST_TEST(result.converged);
+  BOOST_TEST(result.iterations > 1);
+  BOOST_TEST(result.residual_norms.size() == 10);
+  BOOST_TEST(result.residual_norms.maxCoeff() <= 1e-8);
+  check_eigenpairs(A, values, vectors, 10);
+  BOOST_TEST(cp.workspace().used() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(matrix_free_davidson) {
+  CudaPipeline cp;
+  Index n = 300;
+  // Tridiagonal operator applied as a sparse product
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (Index i = 0; i < n; i++) {
+    triplets.emplace_back(i, i, 2. + 0.1 * double(i));
+    if (i + 1 < n) {
+      triplets.emplace_back(i, i + 1, -0.05);
+      triplets.emplace_back(i + 1, i, -0.05);
+    }
+  }
+  Eigen::SparseMatrix<double> sparse(n, n);
+  sparse.setFromTriplets(triplets.begin(), triplets.end());
+  CudaSparseMatrix cuda_sparse{sparse, cp.get_stream()};
+  LinearOperator apply = [&cp, &cuda_sparse](const CudaMatrix &X,
+                                             CudaMatrix &Y) {
+    cp.spmm(cuda_sparse, X, Y);
+  };
+  Eigen::VectorXd diagonal = Eigen::MatrixXd(sparse).diagonal();
+  CudaMatrix cuma_diagonal{diagonal, cp.get_stream()};
+  CudaMatrix values{1, 1, cp.get_stream()};
+  CudaMatrix vectors{1, 1, cp.get_stream()};
+
+  DavidsonOptions options;
+  options.block_size = 2;
+  options.tolerance = 1e-9;
+  DavidsonResult result =
+      cp.davidson(apply, cuma_diagonal, 4, values, vectors, options);
+  BOOST_TEST(result.converged);
+  check_eigenpairs(Eigen::MatrixXd(sparse), values, vectors, 4);
+}
+
+BOOST_AUTO_TEST_CASE(davidson_restarts) {
+  CudaPipeline cp;
+  cp.reserve_workspace(1 << 22);
+  Index n = 200;
+  Eigen::MatrixXd A = diagonally_dominant(n);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix values{1, 1, cp.get_stream()};
+  CudaMatrix vectors{1, 1, cp.get_stream()};
+
+  // Room for a single block besides the Ritz vectors, restarting every step
+  DavidsonOptions options;
+  options.max_subspace = 6;
+  options.max_iterations = 500;
+  DavidsonResult result = cp.davidson(cuma_A, 3, values, vectors, options);
+  BOOST_TEST(result.converged);
+  check_eigenpairs(A, values, vectors, 3);
+  BOOST_TEST(cp.workspace().used() == 0);
+
+  // Running out of iterations reports the current residuals
+  options.max_iterations = 1;
+  result = cp.davidson(cuma_A, 3, values, vectors, options);
+  BOOST_TEST(!result.converged);
+  BOOST_TEST(result.iterations == 1);
+  BOOST_TEST(result.residual_norms.maxCoeff() > options.tolerance);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_davidson) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = diagonally_dominant(20);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix rectangular{Eigen::MatrixXd::Random(20, 10), cp.get_stream()};
+  CudaMatrix values{1, 1, cp.get_stream()};
+  CudaMatrix vectors{1, 1, cp.get_stream()};
+  BOOST_CHECK_THROW(cp.davidson(rectangular, 2, values, vectors),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cp.davidson(cuma_A, 0, values, vectors),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cp.davidson(cuma_A, 21, values, vectors),
+                    std::runtime_error);
+  DavidsonOptions options;
+  options.max_subspace = 3;
+  BOOST_CHECK_THROW(cp.davidson(cuma_A, 2, values, vectors, options),
+                    std::runtime_error);
+  options.max_subspace = 21;
+  BOOST_CHECK_THROW(cp.davidson(cuma_A, 2, values, vectors, options),
+                    std::runtime_error);
+}
@@ -0,0 +1,393 @@
+#define BOOST_TEST_MODULE decompositions
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include "side_by_side.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaTensor;
+using eigencuda::Index;
+using eigencuda::Operation;
+using eigencuda::side_by_side;
+
+namespace {
+Eigen::MatrixXd random_symmetric(Index dim) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim);
+  return A + A.transpose();
+}
+
+Eigen::MatrixXd random_positive_definite(Index dim) {
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(dim, dim);
+  return M * M.transpose() + dim * Eigen::MatrixXd::Identity(dim, dim);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(symmetric_eigensolver) {
+  Index dim = 40;
+  Eigen::MatrixXd A = random_symmetric(dim);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_values{1, 1, cuda_pip.get_stream()};
+  CudaMatrix cuma_vectors{1, 1, cuda_pip.get_stream()};
+  cuda_pip.syevd(cuma_A, cuma_values, cuma_vectors);
+
+  Eigen::MatrixXd values = cuma_values;
+  Eigen::MatrixXd vectors = cuma_vectors;
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(A);
+  BOOST_TEST(values.isApprox(solver.eigenvalues()));
+  BOOST_TEST((A * vectors).isApprox(vectors * values.asDiagonal()));
+
+  CpuPipeline cpu_pip;
+  Eigen::MatrixXd cpu_values;
+  Eigen::MatrixXd cpu_vectors;
+  cpu_pip.syevd(A, cpu_values, cpu_vectors);
+  BOOST_TEST(cpu_values.isApprox(values));
+  BOOST_TEST(
+      (A * cpu_vectors).isApprox(cpu_vectors * cpu_values.asDiagonal()));
+}
+
+BOOST_AUTO_TEST_CASE(partial_symmetric_eigensolver) {
+  Index dim = 60;
+  Eigen::MatrixXd A = random_symmetric(dim);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_values{1, 1, cuda_pip.get_stream()};
+  CudaMatrix cuma_vectors{1, 1, cuda_pip.get_stream()};
+  cuda_pip.syevdx(cuma_A, 2, 5, cuma_values, cuma_vectors);
+
+  BOOST_TEST(cuma_values.rows() == 5);
+  BOOST_TEST(cuma_vectors.cols() == 5);
+  Eigen::MatrixXd values = cuma_values;
+  Eigen::MatrixXd vectors = cuma_vectors;
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(A);
+  BOOST_TEST(values.isApprox(solver.eigenvalues().segment(2, 5)));
+  BOOST_TEST((A * vectors).isApprox(vectors * values.asDiagonal()));
+
+  CpuPipeline cpu_pip;
+  Eigen::MatrixXd cpu_values;
+  Eigen::MatrixXd cpu_vectors;
+  cpu_pip.syevdx(A, 2, 5, cpu_values, cpu_vectors);
+  BOOST_TEST(cpu_values.isApprox(values));
+  BOOST_TEST(cpu_vectors.cols() == 5);
+  BOOST_TEST(
+      (A * cpu_vectors).isApprox(cpu_vectors * cpu_values.asDiagonal()));
+
+  BOOST_REQUIRE_THROW(
+      cuda_pip.syevdx(cuma_A, 58, 5, cuma_values, cuma_vectors),
+      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(cholesky_solves) {
+  Index dim = 50;
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd A =
+      M * M.transpose() + dim * Eigen::MatrixXd::Identity(dim, dim);
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  eigencuda::CholeskyFactor factor = cuda_pip.potrf(cuma_A);
+  Eigen::LLT<Eigen::MatrixXd> cpu_factor = cpu_pip.potrf(A);
+
+  // The factor is reused for several right hand sides
+  for (Index nrhs : {1, 3, 10}) {
+    Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, nrhs);
+    CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+    cuda_pip.potrs(factor, cuma_B);
+    Eigen::MatrixXd X = cuma_B;
+    BOOST_TEST((A * X).isApprox(B));
+
+    cpu_pip.potrs(cpu_factor, B);
+    BOOST_TEST(X.isApprox(B));
+  }
+
+  Eigen::MatrixXd N = -Eigen::MatrixXd::Identity(dim, dim);
+  CudaMatrix cuma_N{N, cuda_pip.get_stream()};
+  BOOST_REQUIRE_THROW(cuda_pip.potrf(cuma_N), std::runtime_error);
+  BOOST_REQUIRE_THROW(cpu_pip.potrf(N), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(lu_solves) {
+  Index dim = 45;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim);
+
+  CudaPipeline cuda_pip;
+  cuda_pip.reserve_workspace(1 << 20);
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  eigencuda::LUFactor factor = cuda_pip.getrf(cuma_A);
+  Eigen::PartialPivLU<Eigen::MatrixXd> cpu_factor = cpu_pip.getrf(A);
+
+  for (Index nrhs : {1, 4}) {
+    Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, nrhs);
+    CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+    cuda_pip.getrs(factor, cuma_B);
+    Eigen::MatrixXd X = cuma_B;
+    BOOST_TEST((A * X).isApprox(B));
+
+    cpu_pip.getrs(cpu_factor, B);
+    BOOST_TEST(X.isApprox(B));
+  }
+  // The work arrays come from the workspace
+  BOOST_TEST(cuda_pip.workspace().used() == 0);
+  BOOST_TEST(cuda_pip.workspace().high_water_mark() > 0);
+
+  CudaMatrix cuma_B{dim + 1, 1, cuda_pip.get_stream()};
+  BOOST_REQUIRE_THROW(cuda_pip.getrs(factor, cuma_B), std::runtime_error);
+
+  // Both sides reject exactly singular matrices
+  A.col(3).setZero();
+  cuma_A.copy_to_gpu(A);
+  BOOST_REQUIRE_THROW(cuda_pip.getrf(cuma_A), std::runtime_error);
+  BOOST_REQUIRE_THROW(cpu_pip.getrf(A), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(randomized_svd) {
+  // Rank 8 matrix plus a small perturbation
+  Index rows = 120;
+  Index cols = 70;
+  Index rank = 8;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(rows, rank) *
+                          Eigen::MatrixXd::Random(rank, cols) +
+                      1e-8 * Eigen::MatrixXd::Random(rows, cols);
+  Eigen::JacobiSVD<Eigen::MatrixXd> exact(A);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_U{1, 1, cuda_pip.get_stream()};
+  CudaMatrix cuma_S{1, 1, cuda_pip.get_stream()};
+  CudaMatrix cuma_V{1, 1, cuda_pip.get_stream()};
+  cuda_pip.randomized_svd(cuma_A, rank, cuma_U, cuma_S, cuma_V);
+
+  Eigen::MatrixXd U = cuma_U;
+  Eigen::MatrixXd S = cuma_S;
+  Eigen::MatrixXd V = cuma_V;
+  BOOST_TEST(U.cols() == rank);
+  BOOST_TEST(V.cols() == rank);
+  BOOST_TEST(S.isApprox(exact.singularValues().head(rank)));
+  BOOST_TEST((U.transpose() * U).isIdentity(1e-10));
+  BOOST_TEST((V.transpose() * V).isIdentity(1e-10));
+  BOOST_TEST((U * S.asDiagonal() * V.transpose()).isApprox(A, 1e-6));
+
+  // Same sketch on the host
+  CpuPipeline cpu_pip;
+  Eigen::MatrixXd cpu_U;
+  Eigen::MatrixXd cpu_S;
+  Eigen::MatrixXd cpu_V;
+  cpu_pip.randomized_svd(A, rank, cpu_U, cpu_S, cpu_V);
+  BOOST_TEST(cpu_S.isApprox(S));
+  BOOST_TEST((cpu_U * cpu_S.asDiagonal() * cpu_V.transpose())
+                 .isApprox(U * S.asDiagonal() * V.transpose(), 1e-8));
+
+  BOOST_CHECK_THROW(
+      cuda_pip.randomized_svd(cuma_A, cols + 1, cuma_U, cuma_S, cuma_V),
+      std::runtime_error);
+  BOOST_CHECK_THROW(cpu_pip.randomized_svd(A, 0, cpu_U, cpu_S, cpu_V),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(randomized_svd_in_workspace) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(60, 50);
+  CudaPipeline cuda_pip;
+  cuda_pip.reserve_workspace(1 << 20);
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_U{1, 1, cuda_pip.get_stream()};
+  CudaMatrix cuma_S{1, 1, cuda_pip.get_stream()};
+  CudaMatrix cuma_V{1, 1, cuda_pip.get_stream()};
+
+  // The oversampling is clamped to the 50 columns, so the sketch spans the
+  // whole range and the leading singular values are exact
+  Eigen::JacobiSVD<Eigen::MatrixXd> exact(A);
+  for (int call = 0; call < 2; call++) {
+    cuda_pip.randomized_svd(cuma_A, 5, cuma_U, cuma_S, cuma_V, 100, 1);
+    BOOST_TEST(Eigen::MatrixXd(cuma_S).isApprox(
+        exact.singularValues().head(5), 1e-6));
+    // The temporaries are released after every call
+    BOOST_TEST(cuda_pip.workspace().used() == 0);
+  }
+  BOOST_TEST(cuda_pip.workspace().high_water_mark() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(triangular_operations) {
+  using eigencuda::Diagonal;
+  using eigencuda::RowMajorMatrixXd;
+  using eigencuda::Side;
+  using eigencuda::Triangle;
+  Index dim = 12;
+  // Dominant diagonal, the solves are well conditioned
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim) +
+                      4. * Eigen::MatrixXd::Identity(dim, dim);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, 5);
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix row_major_A{RowMajorMatrixXd(A), cuda_pip.get_stream()};
+  CudaMatrix cuma_C{1, 1, cuda_pip.get_stream()};
+  for (Side side : {Side::Left, Side::Right}) {
+    bool left = (side == Side::Left);
+    Eigen::MatrixXd rhs = left ? B : Eigen::MatrixXd(B.transpose());
+    for (Triangle triangle : {Triangle::Lower, Triangle::Upper}) {
+      for (Operation op : {Operation::None, Operation::Transpose}) {
+        for (Diagonal diagonal : {Diagonal::NonUnit, Diagonal::Unit}) {
+          Eigen::MatrixXd T = A;
+          if (triangle == Triangle::Lower) {
+            T = A.triangularView<Eigen::Lower>();
+          } else {
+            T = A.triangularView<Eigen::Upper>();
+          }
+          if (diagonal == Diagonal::Unit) {
+            T.diagonal().setOnes();
+          }
+          if (op == Operation::Transpose) {
+            T.transposeInPlace();
+          }
+          Eigen::MatrixXd product = 2. * (left ? T * rhs : rhs * T);
+          Eigen::MatrixXd inverse = T.inverse();
+          Eigen::MatrixXd solution = left ? inverse * rhs : rhs * inverse;
+
+          CudaMatrix cuma_B{rhs, cuda_pip.get_stream()};
+          cuda_pip.trmm(cuma_A, cuma_B, cuma_C, side, triangle, op, diagonal,
+                        2.);
+          BOOST_TEST(Eigen::MatrixXd(cuma_C).isApprox(product));
+          cuda_pip.trmm(row_major_A, cuma_B, cuma_C, side, triangle, op,
+                        diagonal, 2.);
+          BOOST_TEST(Eigen::MatrixXd(cuma_C).isApprox(product));
+          cuda_pip.trsm(cuma_A, cuma_B, side, triangle, op, diagonal);
+          BOOST_TEST(Eigen::MatrixXd(cuma_B).isApprox(solution));
+
+          // Row major right-hand sides are handled on the buffers
+          CudaMatrix row_major_B{RowMajorMatrixXd(rhs), cuda_pip.get_stream()};
+          cuda_pip.trsm(cuma_A, row_major_B, side, triangle, op, diagonal);
+          BOOST_TEST(Eigen::MatrixXd(row_major_B).isApprox(solution));
+
+          Eigen::MatrixXd host_C;
+          cpu_pip.trmm(A, rhs, host_C, side, triangle, op, diagonal, 2.);
+          BOOST_TEST(host_C.isApprox(product));
+          Eigen::MatrixXd host_B = rhs;
+          cpu_pip.trsm(A, host_B, side, triangle, op, diagonal);
+          BOOST_TEST(host_B.isApprox(solution));
+        }
+      }
+    }
+  }
+
+  BOOST_CHECK_THROW(cuda_pip.trsm(cuma_A, cuma_C, Side::Left, Triangle::Full),
+                    std::runtime_error);
+  CudaMatrix wide{Eigen::MatrixXd::Random(3, dim), cuda_pip.get_stream()};
+  BOOST_CHECK_THROW(cuda_pip.trsm(cuma_A, wide), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(cholesky_triangular_solves) {
+  Index dim = 30;
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd A =
+      M * M.transpose() + dim * Eigen::MatrixXd::Identity(dim, dim);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, 8);
+
+  // L^-1 * B with the factor kept in the device
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+  auto factor = cuda_pip.potrf(cuma_A);
+  cuda_pip.trsm(factor.matrix(), cuma_B);
+
+  Eigen::LLT<Eigen::MatrixXd> llt(A);
+  Eigen::MatrixXd expected = llt.matrixL().solve(B);
+  BOOST_TEST(Eigen::MatrixXd(cuma_B).isApprox(expected));
+}
+
+BOOST_AUTO_TEST_CASE(batched_inverse) {
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  // matinvBatched, the LU path and the dynamic size of the host
+  for (Index dim : {8, 40, 13}) {
+    std::vector<Eigen::MatrixXd> matrices;
+    for (Index i = 0; i < 30; i++) {
+      matrices.push_back(random_positive_definite(dim));
+    }
+    CudaTensor cuda_A{matrices, cuda_pip.get_stream()};
+    CudaTensor cuda_inverse{1, 1, 1, cuda_pip.get_stream()};
+    cuda_pip.inverse_batched(cuda_A, cuda_inverse);
+    std::vector<Eigen::MatrixXd> inverses = cuda_inverse;
+
+    Eigen::MatrixXd inverse;
+    cpu_pip.inverse_batched(side_by_side(matrices), inverse, 30);
+    for (Index i = 0; i < 30; i++) {
+      Eigen::MatrixXd identity = matrices[i] * inverses[i];
+      BOOST_TEST(identity.isIdentity(1e-10));
+      BOOST_TEST(inverse.middleCols(i * dim, dim).isApprox(inverses[i]));
+    }
+
+    // The error names the singular matrix
+    matrices[7].setZero();
+    cuda_A.copy_to_gpu(matrices);
+    BOOST_CHECK_EXCEPTION(cuda_pip.inverse_batched(cuda_A, cuda_inverse),
+                          std::runtime_error, [](const std::runtime_error &e) {
+                            return std::string(e.what()).find("matrix 7") !=
+                                   std::string::npos;
+                          });
+    BOOST_REQUIRE_THROW(
+        cpu_pip.inverse_batched(side_by_side(matrices), inverse, 30),
+        std::runtime_error);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batched_cholesky_and_lu_solves) {
+  Index dim = 24;
+  Index batch = 50;
+  std::vector<Eigen::MatrixXd> matrices;
+  std::vector<Eigen::MatrixXd> rhs;
+  for (Index i = 0; i < batch; i++) {
+    matrices.push_back(random_positive_definite(dim));
+    rhs.push_back(Eigen::MatrixXd::Random(dim, 3));
+  }
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaTensor cuda_A{matrices, cuda_pip.get_stream()};
+  Eigen::MatrixXd A = side_by_side(matrices);
+
+  eigencuda::BatchedCholeskyFactor cholesky = cuda_pip.potrf_batched(cuda_A);
+  CudaTensor cuda_B{rhs, cuda_pip.get_stream()};
+  cuda_pip.potrs_batched(cholesky, cuda_B);
+  std::vector<Eigen::MatrixXd> X = cuda_B;
+  Eigen::MatrixXd B = side_by_side(rhs);
+  cpu_pip.potrs_batched(cpu_pip.potrf_batched(A, batch), B);
+  for (Index i = 0; i < batch; i++) {
+    BOOST_TEST((matrices[i] * X[i]).isApprox(rhs[i]));
+    BOOST_TEST(B.middleCols(i * 3, 3).isApprox(X[i]));
+  }
+
+  eigencuda::BatchedLUFactor lu = cuda_pip.getrf_batched(cuda_A);
+  cuda_B.copy_to_gpu(rhs);
+  cuda_pip.getrs_batched(lu, cuda_B);
+  X = cuda_B;
+  B = side_by_side(rhs);
+  cpu_pip.getrs_batched(cpu_pip.getrf_batched(A, batch), B);
+  for (Index i = 0; i < batch; i++) {
+    BOOST_TEST((matrices[i] * X[i]).isApprox(rhs[i]));
+    BOOST_TEST(B.middleCols(i * 3, 3).isApprox(X[i]));
+  }
+
+  matrices[3] = -matrices[3];
+  cuda_A.copy_to_gpu(matrices);
+  BOOST_REQUIRE_THROW(cuda_pip.potrf_batched(cuda_A), std::runtime_error);
+  BOOST_REQUIRE_THROW(cpu_pip.potrf_batched(side_by_side(matrices), batch),
+                      std::runtime_error);
+  CudaTensor wrong{dim, 3, batch - 1, cuda_pip.get_stream()};
+  BOOST_REQUIRE_THROW(cuda_pip.potrs_batched(cholesky, wrong),
+                      std::runtime_error);
+
+  // The error names the singular matrix
+  matrices[5].setZero();
+  BOOST_CHECK_EXCEPTION(
+      cpu_pip.getrf_batched(side_by_side(matrices), batch),
+      std::runtime_error, [](const std::runtime_error &e) {
+        return std::string(e.what()).find("Matrix 5") != std::string::npos;
+      });
+}
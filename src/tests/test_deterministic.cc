@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE deterministic
+
+#include "cudapipeline.hpp"
+#include "cudasparse.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaSparseMatrix;
+using eigencuda::CudaTensor;
+using eigencuda::CudaVector;
+using eigencuda::Operation;
+
+namespace {
+bool bitwise_equal(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B) {
+  return A.rows() == B.rows() && A.cols() == B.cols() &&
+         (A.array() == B.array()).all();
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(toggle_mode) {
+  CudaPipeline cp;
+  BOOST_TEST(!cp.deterministic());
+  cp.set_deterministic(true);
+  BOOST_TEST(cp.deterministic());
+  cp.set_deterministic(false);
+  BOOST_TEST(!cp.deterministic());
+}
+
+BOOST_AUTO_TEST_CASE(repeated_dense_operations) {
+  CudaPipeline cp;
+  cp.set_deterministic(true);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(150, 70);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(70, 90);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  CudaMatrix cuma_C{150, 90, cp.get_stream()};
+
+  cp.gemm(cuma_A, cuma_B, cuma_C);
+  Eigen::MatrixXd first = cuma_C;
+  double norm = cp.norm(cuma_C);
+  for (int run = 0; run < 3; run++) {
+    cp.gemm(cuma_A, cuma_B, cuma_C);
+    BOOST_TEST(bitwise_equal(cuma_C, first));
+    BOOST_TEST(cp.norm(cuma_C) == norm);
+  }
+
+  // Batched products, both the specialized kernels and cublas
+  for (Eigen::Index n : {5, 40}) {
+    std::vector<Eigen::MatrixXd> matrices(7, Eigen::MatrixXd::Random(n, n));
+    CudaTensor tensor_A{matrices, cp.get_stream()};
+    CudaTensor tensor_B{matrices, cp.get_stream()};
+    CudaTensor tensor_C{n, n, 7, cp.get_stream()};
+    cp.gemm_batched(tensor_A, tensor_B, tensor_C);
+    Eigen::MatrixXd slice = tensor_C.slice(6);
+    cp.gemm_batched(tensor_A, tensor_B, tensor_C);
+    BOOST_TEST(bitwise_equal(tensor_C.slice(6), slice));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(repeated_sparse_products) {
+  CudaPipeline cp;
+  cp.set_deterministic(true);
+  Eigen::MatrixXd dense = Eigen::MatrixXd::Random(60, 40);
+  dense = (dense.array().abs() > 0.8).select(dense, 0.);
+  Eigen::SparseMatrix<double> A = dense.sparseView();
+  CudaSparseMatrix cuda_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{Eigen::MatrixXd::Random(40, 8), cp.get_stream()};
+  CudaMatrix cuma_C{60, 8, cp.get_stream()};
+  Eigen::VectorXd x = Eigen::VectorXd::Random(60);
+  CudaVector cuda_x{x, cp.get_stream()};
+  CudaVector cuda_y{40, cp.get_stream()};
+
+  cp.spmm(cuda_A, cuma_B, cuma_C);
+  cp.spmv(cuda_A, cuda_x, cuda_y, 1., 0., Operation::Transpose);
+  Eigen::MatrixXd C = cuma_C;
+  Eigen::VectorXd y = cuda_y;
+  cp.spmm(cuda_A, cuma_B, cuma_C);
+  cp.spmv(cuda_A, cuda_x, cuda_y, 1., 0., Operation::Transpose);
+  BOOST_TEST(bitwise_equal(cuma_C, C));
+  BOOST_TEST(bitwise_equal(Eigen::VectorXd(cuda_y), y));
+
+  // The transposed products go through the explicit transpose
+  Eigen::VectorXd expected = A.transpose() * x;
+  BOOST_TEST(y.isApprox(expected));
+  CudaMatrix cuma_X{Eigen::MatrixXd::Random(60, 3), cp.get_stream()};
+  CudaMatrix cuma_Y{40, 3, cp.get_stream()};
+  cp.spmm(cuda_A, cuma_X, cuma_Y, 1., 0., Operation::Transpose);
+  Eigen::MatrixXd Y = cuma_Y;
+  BOOST_TEST(Y.isApprox(A.transpose() * Eigen::MatrixXd(cuma_X)));
+  cp.spmm(cuda_A, cuma_X, cuma_Y, 1., 0., Operation::Transpose);
+  BOOST_TEST(bitwise_equal(cuma_Y, Y));
+}
@@ -101,3 +101,93 @@ BOOST_AUTO_TEST_CASE(wrong_shape_cublas) {
   BOOST_REQUIRE_THROW(cuda_pip.gemm(cuma_A, cuma_B, cuma_C),
                       std::runtime_error);
 }
+
+BOOST_AUTO_TEST_CASE(move_cudamatrix) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(4, 3);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_B = std::move(cuma_A);
+
+  BOOST_TEST(cuma_A.size() == 0);
+  BOOST_TEST(cuma_A.data() == nullptr);
+  BOOST_TEST(A.isApprox(Eigen::MatrixXd(cuma_B)));
+
+  CudaMatrix cuma_C{2, 2, cuda_pip.get_stream()};
+  cuma_C = std::move(cuma_B);
+  BOOST_TEST(cuma_C.rows() == 4);
+  BOOST_TEST(A.isApprox(Eigen::MatrixXd(cuma_C)));
+}
+
+BOOST_AUTO_TEST_CASE(resize_reuses_capacity) {
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{10, 10, cuda_pip.get_stream()};
+  double *data = cuma_A.data();
+
+  // Smaller shapes reuse the allocated memory
+  for (Index i = 1; i < 10; i++) {
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(i, 10 - i);
+    cuma_A.copy_to_gpu(A);
+    BOOST_TEST(cuma_A.data() == data);
+    BOOST_TEST(A.isApprox(Eigen::MatrixXd(cuma_A)));
+  }
+  BOOST_TEST(cuma_A.capacity() == 100);
+
+  cuma_A.resize(20, 10);
+  BOOST_TEST(cuma_A.capacity() == 200);
+
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(3, 4);
+  cuma_A.copy_to_gpu(B);
+  cuma_A.shrink_to_fit();
+  BOOST_TEST(cuma_A.capacity() == 12);
+  BOOST_TEST(B.isApprox(Eigen::MatrixXd(cuma_A)));
+}
+
+BOOST_AUTO_TEST_CASE(reshape_cudamatrix) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(4, 6);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  cuma_A.reshape(8, 3);
+
+  Eigen::MatrixXd B = cuma_A;
+  BOOST_TEST(B.isApprox(Eigen::Map<Eigen::MatrixXd>(A.data(), 8, 3)));
+  BOOST_REQUIRE_THROW(cuma_A.reshape(5, 5), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(managed_matrix_multiplication) {
+  Index dim = 50;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, dim);
+
+  CudaPipeline cuda_pip;
+  const cudaStream_t &stream = cuda_pip.get_stream();
+  CudaMatrix cuma_A{dim, dim, stream, eigencuda::MemoryKind::Managed};
+  CudaMatrix cuma_B{dim, dim, stream, eigencuda::MemoryKind::Managed};
+  CudaMatrix cuma_C{dim, dim, stream, eigencuda::MemoryKind::Managed};
+
+  // Fill the matrices directly from the host
+  cuma_A.host_view() = A;
+  cuma_B.host_view() = B;
+
+  cuda_pip.advise_read_mostly(cuma_A);
+  cuda_pip.advise_read_mostly(cuma_B);
+  cuda_pip.prefetch_to_device(cuma_A);
+  cuda_pip.prefetch_to_device(cuma_B);
+  cuda_pip.gemm(cuma_A, cuma_B, cuma_C);
+  cuda_pip.prefetch_to_host(cuma_C);
+  cudaStreamSynchronize(stream);
+
+  BOOST_TEST(cuma_C.host_view().isApprox(A * B));
+  // Views keep the kind of memory of their matrix
+  BOOST_TEST((cuma_C.middle_cols(1, 2).memory_kind() ==
+              eigencuda::MemoryKind::Managed));
+}
+
+BOOST_AUTO_TEST_CASE(managed_hints_require_managed_memory) {
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{2, 2, cuda_pip.get_stream()};
+
+  BOOST_REQUIRE_THROW(cuma_A.host_view(), std::runtime_error);
+  BOOST_REQUIRE_THROW(cuda_pip.prefetch_to_device(cuma_A), std::runtime_error);
+}
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MODULE elementwise
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::UnaryFunction;
+
+BOOST_AUTO_TEST_CASE(scale_axpy_add) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(30, 20);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(30, 20);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+  CudaMatrix cuma_C{30, 20, cuda_pip.get_stream()};
+
+  CpuPipeline cpu_pip;
+  Eigen::MatrixXd C;
+
+  cuda_pip.scale(cuma_A, 3.);
+  cpu_pip.scale(A, 3.);
+  BOOST_TEST(A.isApprox(Eigen::MatrixXd(cuma_A)));
+
+  cuda_pip.axpy(-2., cuma_A, cuma_B);
+  cpu_pip.axpy(-2., A, B);
+  BOOST_TEST(B.isApprox(Eigen::MatrixXd(cuma_B)));
+
+  cuda_pip.add(cuma_A, cuma_B, cuma_C);
+  cpu_pip.add(A, B, C);
+  BOOST_TEST(C.isApprox(Eigen::MatrixXd(cuma_C)));
+}
+
+BOOST_AUTO_TEST_CASE(hadamard_operations) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(50, 40);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(50, 40).array() + 2.;
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+  CudaMatrix cuma_C{1, 1, cuda_pip.get_stream()};
+
+  CpuPipeline cpu_pip;
+  Eigen::MatrixXd C;
+
+  cuda_pip.hadamard_product(cuma_A, cuma_B, cuma_C);
+  cpu_pip.hadamard_product(A, B, C);
+  BOOST_TEST(C.isApprox(Eigen::MatrixXd(cuma_C)));
+  BOOST_TEST(C.isApprox(A.cwiseProduct(B)));
+
+  cuda_pip.hadamard_division(cuma_A, cuma_B, cuma_C);
+  cpu_pip.hadamard_division(A, B, C);
+  BOOST_TEST(C.isApprox(Eigen::MatrixXd(cuma_C)));
+
+  CudaMatrix cuma_D{3, 3, cuda_pip.get_stream()};
+  BOOST_REQUIRE_THROW(cuda_pip.hadamard_product(cuma_A, cuma_D, cuma_C),
+                      std::runtime_error);
+  Eigen::MatrixXd D = Eigen::MatrixXd::Random(3, 3);
+  BOOST_REQUIRE_THROW(cpu_pip.hadamard_product(A, D, C), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(apply_functions) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(25, 25).array() + 1.5;
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  for (UnaryFunction f :
+       {UnaryFunction::Abs, UnaryFunction::Exp, UnaryFunction::Log,
+        UnaryFunction::Sqrt, UnaryFunction::Square,
+        UnaryFunction::Reciprocal}) {
+    CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+    Eigen::MatrixXd B = A;
+    cuda_pip.apply(cuma_A, f);
+    cpu_pip.apply(B, f);
+    BOOST_TEST(B.isApprox(Eigen::MatrixXd(cuma_A)));
+  }
+}
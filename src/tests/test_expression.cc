@@ -0,0 +1,142 @@
+#define BOOST_TEST_MODULE expression
+
+#include "cudaexpression.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::evaluate;
+using eigencuda::Index;
+using eigencuda::transpose;
+
+BOOST_AUTO_TEST_CASE(product_plus_matrix) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(10, 7);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(7, 5);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(10, 5);
+
+  CudaPipeline cuda_pip;
+  const cudaStream_t &stream = cuda_pip.get_stream();
+  CudaMatrix cuma_A{A, stream};
+  CudaMatrix cuma_B{B, stream};
+  CudaMatrix cuma_C{C, stream};
+  CudaMatrix cuma_D{1, 1, stream};
+
+  evaluate(cuda_pip, cuma_A * cuma_B + cuma_C, cuma_D);
+  BOOST_TEST((A * B + C).isApprox(Eigen::MatrixXd(cuma_D)));
+
+  evaluate(cuda_pip, 2. * (cuma_A * cuma_B) - 3. * cuma_C, cuma_D);
+  BOOST_TEST((2. * A * B - 3. * C).isApprox(Eigen::MatrixXd(cuma_D)));
+}
+
+BOOST_AUTO_TEST_CASE(transposed_operands) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(7, 10);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(7, 10);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(10, 10);
+
+  CudaPipeline cuda_pip;
+  const cudaStream_t &stream = cuda_pip.get_stream();
+  CudaMatrix cuma_A{A, stream};
+  CudaMatrix cuma_B{B, stream};
+  CudaMatrix cuma_C{C, stream};
+  CudaMatrix cuma_D{10, 10, stream};
+
+  evaluate(cuda_pip,
+           0.5 * transpose(cuma_A) * cuma_B + transpose(cuma_C) - cuma_C,
+           cuma_D);
+  Eigen::MatrixXd expected =
+      0.5 * A.transpose() * B + C.transpose() - C;
+  BOOST_TEST(expected.isApprox(Eigen::MatrixXd(cuma_D)));
+}
+
+BOOST_AUTO_TEST_CASE(accumulate_and_alias) {
+  Index dim = 20;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd D = Eigen::MatrixXd::Random(dim, dim);
+
+  CudaPipeline cuda_pip;
+  const cudaStream_t &stream = cuda_pip.get_stream();
+  CudaMatrix cuma_A{A, stream};
+  CudaMatrix cuma_B{B, stream};
+  CudaMatrix cuma_D{D, stream};
+
+  // D is updated in place by the beta of gemm
+  evaluate(cuda_pip, cuma_A * cuma_B + 2. * cuma_D, cuma_D);
+  D = A * B + 2. * D;
+  BOOST_TEST(D.isApprox(Eigen::MatrixXd(cuma_D)));
+
+  // D is a factor of the product and needs a temporary
+  evaluate(cuda_pip, cuma_D * cuma_B, cuma_D);
+  D = D * B;
+  BOOST_TEST(D.isApprox(Eigen::MatrixXd(cuma_D)));
+
+  evaluate(cuda_pip, -cuma_A * cuma_B + cuma_A, cuma_D);
+  BOOST_TEST((A - A * B).isApprox(Eigen::MatrixXd(cuma_D)));
+
+  // Views of one buffer that overlap at different offsets, the temporary
+  // comes from the workspace
+  cuda_pip.reserve_workspace(1 << 20);
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(dim, 2 * dim);
+  CudaMatrix cuma_M{M, stream};
+  CudaMatrix left = cuma_M.middle_cols(0, dim);
+  CudaMatrix shifted = cuma_M.middle_cols(dim / 2, dim);
+  evaluate(cuda_pip, shifted * cuma_B, left);
+  BOOST_TEST((M.middleCols(dim / 2, dim) * B)
+                 .isApprox(Eigen::MatrixXd(cuma_M).leftCols(dim)));
+  M = cuma_M;
+  evaluate(cuda_pip, transpose(left) + shifted, shifted);
+  Eigen::MatrixXd expected =
+      M.leftCols(dim).transpose() + M.middleCols(dim / 2, dim);
+  BOOST_TEST(expected.isApprox(Eigen::MatrixXd(shifted)));
+  BOOST_TEST(cuda_pip.workspace().used() == 0);
+  BOOST_TEST(cuda_pip.workspace().high_water_mark() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(expression_shape_mismatch) {
+  CudaPipeline cuda_pip;
+  const cudaStream_t &stream = cuda_pip.get_stream();
+  CudaMatrix cuma_A{3, 4, stream};
+  CudaMatrix cuma_B{4, 5, stream};
+  CudaMatrix cuma_C{3, 4, stream};
+  CudaMatrix cuma_D{1, 1, stream};
+
+  BOOST_REQUIRE_THROW(evaluate(cuda_pip, cuma_A * cuma_B + cuma_C, cuma_D),
+                      std::runtime_error);
+  BOOST_REQUIRE_THROW(evaluate(cuda_pip, cuma_A * cuma_C, cuma_D),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(nested_products) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(6, 8);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(8, 5);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(5, 7);
+  Eigen::MatrixXd E = Eigen::MatrixXd::Random(6, 7);
+
+  CudaPipeline cuda_pip;
+  cuda_pip.reserve_workspace(1 << 16);
+  const cudaStream_t &stream = cuda_pip.get_stream();
+  CudaMatrix cuma_A{A, stream};
+  CudaMatrix cuma_B{B, stream};
+  CudaMatrix cuma_C{C, stream};
+  CudaMatrix cuma_E{E, stream};
+  CudaMatrix cuma_D{1, 1, stream};
+
+  evaluate(cuda_pip, cuma_A * cuma_B * cuma_C, cuma_D);
+  BOOST_TEST((A * B * C).isApprox(Eigen::MatrixXd(cuma_D)));
+
+  evaluate(cuda_pip, cuma_A * (cuma_B * cuma_C) - 2. * cuma_E, cuma_D);
+  BOOST_TEST((A * B * C - 2. * E).isApprox(Eigen::MatrixXd(cuma_D)));
+
+  evaluate(cuda_pip,
+           (0.5 * transpose(cuma_B) * transpose(cuma_A)) *
+               (cuma_E * transpose(cuma_C)),
+           cuma_D);
+  Eigen::MatrixXd expected =
+      0.5 * B.transpose() * A.transpose() * E * C.transpose();
+  BOOST_TEST(expected.isApprox(Eigen::MatrixXd(cuma_D)));
+
+  // The inner products are released with the expression
+  BOOST_TEST(cuda_pip.workspace().used() == 0);
+  BOOST_REQUIRE_THROW(evaluate(cuda_pip, cuma_A * cuma_B * cuma_E, cuma_D),
+                      std::runtime_error);
+}
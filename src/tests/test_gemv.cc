@@ -0,0 +1,89 @@
+#define BOOST_TEST_MODULE gemv
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include "cudavector.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaVector;
+using eigencuda::Operation;
+
+BOOST_AUTO_TEST_CASE(vector_transfers) {
+  CudaPipeline cp;
+  Eigen::VectorXd v = Eigen::VectorXd::Random(17);
+  CudaVector cuda_v{v, cp.get_stream()};
+  BOOST_TEST(cuda_v.rows() == 17);
+  BOOST_TEST(cuda_v.cols() == 1);
+
+  Eigen::VectorXd w;
+  cuda_v.copy_to_host(w);
+  cp.synchronize();
+  BOOST_TEST(w.isApprox(v));
+
+  // Uploading a longer vector grows the device copy
+  Eigen::VectorXd u = Eigen::VectorXd::Random(40);
+  cuda_v.copy_to_gpu(u);
+  Eigen::VectorXd result = cuda_v;
+  BOOST_TEST(result.isApprox(u));
+}
+
+BOOST_AUTO_TEST_CASE(matrix_vector_product) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(30, 20);
+  Eigen::VectorXd x = Eigen::VectorXd::Random(20);
+  Eigen::VectorXd z = Eigen::VectorXd::Random(30);
+
+  CudaMatrix cuda_A{A, cp.get_stream()};
+  CudaVector cuda_x{x, cp.get_stream()};
+  CudaVector cuda_y{1, cp.get_stream()};
+  cp.gemv(cuda_A, cuda_x, cuda_y);
+  Eigen::VectorXd y = cuda_y;
+  BOOST_TEST(y.isApprox(A * x));
+
+  // Accumulate the transposed product into an existing vector
+  CudaVector cuda_z{z, cp.get_stream()};
+  CudaVector cuda_w{z, cp.get_stream()};
+  cp.gemv(cuda_A, cuda_z, cuda_x, 2., -1., Operation::Transpose);
+  Eigen::VectorXd expected = 2. * A.transpose() * z - x;
+  Eigen::VectorXd result = cuda_x;
+  BOOST_TEST(result.isApprox(expected));
+
+  Eigen::VectorXd host = x;
+  cpu.gemv(A, z, host, 2., -1., Operation::Transpose);
+  BOOST_TEST(host.isApprox(expected));
+
+  BOOST_CHECK_THROW(cp.gemv(cuda_A, cuda_w, cuda_y, 1., 1.),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(batched_matrix_vector_product) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(25, 25);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(25, 6);
+
+  CudaMatrix cuda_A{A, cp.get_stream()};
+  CudaMatrix cuda_X{X, cp.get_stream()};
+  CudaMatrix cuda_Y{1, 1, cp.get_stream()};
+  cp.gemv_batched(cuda_A, cuda_X, cuda_Y, Operation::Transpose);
+  Eigen::MatrixXd Y = cuda_Y;
+
+  // Each column matches an independent gemv
+  CudaVector cuda_x{1, cp.get_stream()};
+  CudaVector cuda_y{1, cp.get_stream()};
+  for (Eigen::Index i = 0; i < X.cols(); i++) {
+    cuda_x.copy_to_gpu(X.col(i));
+    cp.gemv(cuda_A, cuda_x, cuda_y, 1., 0., Operation::Transpose);
+    Eigen::VectorXd y = cuda_y;
+    BOOST_TEST(Y.col(i).isApprox(y));
+  }
+
+  Eigen::MatrixXd host;
+  cpu.gemv_batched(A, X, host, Operation::Transpose);
+  BOOST_TEST(host.isApprox(A.transpose() * X));
+  BOOST_TEST(Y.isApprox(host));
+}
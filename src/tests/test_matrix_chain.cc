@@ -0,0 +1,91 @@
+#define BOOST_TEST_MODULE matrix_chain
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::ChainPlan;
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Index;
+using eigencuda::RowMajorMatrixXd;
+
+BOOST_AUTO_TEST_CASE(optimal_order) {
+  // (A * B) * C needs 7500 multiplications, A * (B * C) 75000
+  ChainPlan plan{{10, 100, 5, 50}};
+  BOOST_TEST(plan.parenthesization() == "((0 1) 2)");
+  BOOST_TEST(plan.flops() == 2. * 7500);
+  BOOST_TEST(plan.steps().size() == 2);
+
+  // Textbook example of Cormen et al. with 15125 multiplications
+  ChainPlan textbook{{30, 35, 15, 5, 10, 20, 25}};
+  BOOST_TEST(textbook.parenthesization() == "((0 (1 2)) ((3 4) 5))");
+  BOOST_TEST(textbook.flops() == 2. * 15125);
+  BOOST_TEST(textbook.result_slot() == int(textbook.slot_sizes().size()) - 1);
+  BOOST_TEST(textbook.slot_sizes().back() == 30 * 25);
+}
+
+BOOST_AUTO_TEST_CASE(recycled_temporaries) {
+  // All the orders cost the same, the first split wins. Every product reuses
+  // the buffer of the intermediate before the previous one
+  ChainPlan plan{{8, 8, 8, 8, 8, 8, 8}};
+  BOOST_TEST(plan.parenthesization() == "(0 (1 (2 (3 (4 5)))))");
+  Index temporaries = Index(plan.slot_sizes().size()) - plan.length() - 1;
+  BOOST_TEST(temporaries == 2);
+  BOOST_TEST(plan.peak_memory() == 2 * 64);
+}
+
+BOOST_AUTO_TEST_CASE(chain_products) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  std::vector<Index> dims{40, 3, 60, 2, 50, 7};
+  std::vector<Eigen::MatrixXd> matrices;
+  for (std::size_t i = 0; i + 1 < dims.size(); i++) {
+    matrices.push_back(Eigen::MatrixXd::Random(dims[i], dims[i + 1]));
+  }
+  Eigen::MatrixXd expected = matrices[0];
+  for (std::size_t i = 1; i < matrices.size(); i++) {
+    expected = expected * matrices[i];
+  }
+
+  Eigen::MatrixXd host_result;
+  cpu.chain_product({matrices[0], matrices[1], matrices[2], matrices[3],
+                     matrices[4]},
+                    host_result);
+  BOOST_TEST(host_result.isApprox(expected));
+
+  // A row major operand is multiplied in place
+  RowMajorMatrixXd row_major = matrices[2];
+  std::vector<CudaMatrix> cuda_matrices;
+  for (const Eigen::MatrixXd &matrix : matrices) {
+    cuda_matrices.emplace_back(matrix, cp.get_stream());
+  }
+  cuda_matrices[2] = CudaMatrix{row_major, cp.get_stream()};
+  CudaMatrix result{1, 1, cp.get_stream()};
+  ChainPlan plan{dims};
+  for (bool workspace : {false, true}) {
+    if (workspace) {
+      cp.reserve_workspace(1 << 20);
+    }
+    cp.chain_product(plan,
+                     {cuda_matrices[0], cuda_matrices[1], cuda_matrices[2],
+                      cuda_matrices[3], cuda_matrices[4]},
+                     result);
+    BOOST_TEST(Eigen::MatrixXd(result).isApprox(expected));
+  }
+  BOOST_TEST(cp.workspace().used() == 0);
+
+  // A single operand is copied
+  cp.chain_product({cuda_matrices[1]}, result);
+  BOOST_TEST(Eigen::MatrixXd(result).isApprox(matrices[1]));
+
+  BOOST_CHECK_THROW(cp.chain_product({cuda_matrices[0], cuda_matrices[2]},
+                                     result),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cp.chain_product(plan,
+                                     {cuda_matrices[0], cuda_matrices[1]},
+                                     result),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(ChainPlan{std::vector<Index>{4}}, std::runtime_error);
+}
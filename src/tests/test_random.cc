@@ -0,0 +1,54 @@
+#define BOOST_TEST_MODULE random
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Distribution;
+
+BOOST_AUTO_TEST_CASE(host_and_device_sequences) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  // Odd size, the last Philox block is only half used
+  CudaMatrix cuma_A{101, 33, cp.get_stream()};
+  Eigen::MatrixXd A(101, 33);
+
+  cp.random(cuma_A, Distribution::Uniform, 42);
+  cpu.random(A, Distribution::Uniform, 42);
+  BOOST_TEST((Eigen::MatrixXd(cuma_A).array() == A.array()).all());
+  BOOST_TEST(A.minCoeff() > 0.);
+  BOOST_TEST(A.maxCoeff() < 1.);
+  BOOST_TEST(std::abs(A.mean() - 0.5) < 0.02);
+
+  cp.random(cuma_A, Distribution::Normal, 42, 3);
+  cpu.random(A, Distribution::Normal, 42, 3);
+  BOOST_TEST(Eigen::MatrixXd(cuma_A).isApprox(A, 1e-12));
+  double mean = A.mean();
+  double variance = (A.array() - mean).square().mean();
+  BOOST_TEST(std::abs(mean) < 0.05);
+  BOOST_TEST(std::abs(variance - 1.) < 0.05);
+}
+
+BOOST_AUTO_TEST_CASE(seeds_and_subsequences) {
+  CpuPipeline cpu;
+  Eigen::MatrixXd A(20, 20);
+  Eigen::MatrixXd B(20, 20);
+  cpu.random(A, Distribution::Uniform, 7);
+  cpu.random(B, Distribution::Uniform, 7);
+  BOOST_TEST((A.array() == B.array()).all());
+
+  // Different seeds and subsequences give unrelated numbers
+  cpu.random(B, Distribution::Uniform, 8);
+  BOOST_TEST((A.array() != B.array()).all());
+  cpu.random(B, Distribution::Uniform, 7, 1);
+  BOOST_TEST((A.array() != B.array()).all());
+
+  // Element i only depends on its position in the sequence
+  Eigen::MatrixXd C(40, 20);
+  cpu.random(C, Distribution::Uniform, 7);
+  Eigen::Map<Eigen::MatrixXd> head(C.data(), 20, 20);
+  BOOST_TEST((head.array() == A.array()).all());
+}
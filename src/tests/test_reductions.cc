@@ -0,0 +1,57 @@
+#define BOOST_TEST_MODULE reductions
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Norm;
+
+BOOST_AUTO_TEST_CASE(matrix_norms) {
+  // Large enough to need several partial results
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(300, 400);
+  A(123, 321) = -5.;
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+
+  BOOST_CHECK_CLOSE(cuda_pip.norm(cuma_A), A.norm(), 1e-10);
+  BOOST_CHECK_CLOSE(cpu_pip.norm(A), A.norm(), 1e-10);
+  BOOST_TEST(cuda_pip.norm(cuma_A, Norm::MaxAbs) == 5.);
+  BOOST_TEST(cpu_pip.norm(A, Norm::MaxAbs) == 5.);
+}
+
+BOOST_AUTO_TEST_CASE(sum_trace_dot) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(150, 150);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(150, 150);
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+
+  BOOST_CHECK_CLOSE(cuda_pip.sum(cuma_A), A.sum(), 1e-8);
+  BOOST_CHECK_CLOSE(cuda_pip.trace(cuma_A), A.trace(), 1e-8);
+  BOOST_CHECK_CLOSE(cuda_pip.dot(cuma_A, cuma_B), cpu_pip.dot(A, B), 1e-8);
+  BOOST_CHECK_CLOSE(cpu_pip.trace(A), A.trace(), 1e-10);
+
+  CudaMatrix cuma_C{3, 2, cuda_pip.get_stream()};
+  BOOST_REQUIRE_THROW(cuda_pip.trace(cuma_C), std::runtime_error);
+  BOOST_REQUIRE_THROW(cuda_pip.dot(cuma_A, cuma_C), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(column_norms) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(500, 300);
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+
+  Eigen::VectorXd expected = cpu_pip.column_norms(A);
+  BOOST_TEST(expected.size() == 300);
+  BOOST_TEST(expected.isApprox(cuda_pip.column_norms(cuma_A)));
+  BOOST_CHECK_CLOSE(expected(7), A.col(7).norm(), 1e-10);
+}
@@ -0,0 +1,100 @@
+#define BOOST_TEST_MODULE sparse
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include "cudasparse.hpp"
+#include <boost/test/unit_test.hpp>
+#include <random>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaSparseMatrix;
+using eigencuda::CudaVector;
+using eigencuda::Operation;
+
+namespace {
+// Random matrix with roughly `fill` of its entries different from zero
+Eigen::SparseMatrix<double> random_sparse(Eigen::Index rows, Eigen::Index cols,
+                                          double fill) {
+  std::mt19937 generator{42};
+  std::uniform_real_distribution<double> distribution{-1., 1.};
+  std::bernoulli_distribution keep{fill};
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (Eigen::Index j = 0; j < cols; j++) {
+    for (Eigen::Index i = 0; i < rows; i++) {
+      if (keep(generator)) {
+        triplets.emplace_back(i, j, distribution(generator));
+      }
+    }
+  }
+  Eigen::SparseMatrix<double> result(rows, cols);
+  result.setFromTriplets(triplets.begin(), triplets.end());
+  return result;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(sparse_transfers) {
+  CudaPipeline cp;
+  Eigen::SparseMatrix<double> A = random_sparse(50, 30, 0.05);
+  CudaSparseMatrix cuda_A{A, cp.get_stream()};
+  BOOST_TEST(cuda_A.rows() == 50);
+  BOOST_TEST(cuda_A.cols() == 30);
+  BOOST_TEST(cuda_A.nonzeros() == A.nonZeros());
+
+  Eigen::SparseMatrix<double> result = cuda_A;
+  BOOST_TEST(Eigen::MatrixXd(result).isApprox(Eigen::MatrixXd(A)));
+}
+
+BOOST_AUTO_TEST_CASE(sparse_dense_products) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  Eigen::SparseMatrix<double> A = random_sparse(60, 40, 0.05);
+  Eigen::MatrixXd dense_A = A;
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(40, 7);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(40, 7);
+
+  CudaSparseMatrix cuda_A{A, cp.get_stream()};
+  CudaMatrix cuda_B{B, cp.get_stream()};
+  CudaMatrix cuda_C{1, 1, cp.get_stream()};
+  cp.spmm(cuda_A, cuda_B, cuda_C);
+  Eigen::MatrixXd result = cuda_C;
+  BOOST_TEST(result.isApprox(dense_A * B));
+
+  // Accumulate the transposed product
+  CudaMatrix cuda_D{C, cp.get_stream()};
+  cp.spmm(cuda_A, cuda_C, cuda_D, 0.5, 2., Operation::Transpose);
+  Eigen::MatrixXd expected = 0.5 * dense_A.transpose() * result + 2. * C;
+  Eigen::MatrixXd D = cuda_D;
+  BOOST_TEST(D.isApprox(expected));
+
+  Eigen::MatrixXd host = C;
+  cpu.spmm(A, result, host, 0.5, 2., Operation::Transpose);
+  BOOST_TEST(host.isApprox(expected));
+
+  BOOST_CHECK_THROW(cp.spmm(cuda_A, cuda_C, cuda_D), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_vector_products) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  Eigen::SparseMatrix<double> A = random_sparse(80, 80, 0.02);
+  Eigen::MatrixXd dense_A = A;
+  Eigen::VectorXd x = Eigen::VectorXd::Random(80);
+
+  CudaSparseMatrix cuda_A{A, cp.get_stream()};
+  CudaVector cuda_x{x, cp.get_stream()};
+  CudaVector cuda_y{1, cp.get_stream()};
+  cp.spmv(cuda_A, cuda_x, cuda_y, 1., 0., Operation::Transpose);
+  Eigen::VectorXd y = cuda_y;
+  BOOST_TEST(y.isApprox(dense_A.transpose() * x));
+
+  cp.spmv(cuda_A, cuda_x, cuda_y, -1., 1.);
+  Eigen::VectorXd expected = dense_A.transpose() * x - dense_A * x;
+  Eigen::VectorXd result = cuda_y;
+  BOOST_TEST(result.isApprox(expected));
+
+  Eigen::VectorXd host;
+  cpu.spmv(A, x, host);
+  BOOST_TEST(host.isApprox(dense_A * x));
+}
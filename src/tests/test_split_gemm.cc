@@ -0,0 +1,128 @@
+#define BOOST_TEST_MODULE split_gemm
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Index;
+using eigencuda::SplitArithmetic;
+
+namespace {
+using MatrixXld = Eigen::Matrix<long double, Eigen::Dynamic, Eigen::Dynamic>;
+
+// Rows of very different magnitudes, which the splitting scales away
+Eigen::MatrixXd graded(Index rows, Index cols) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(rows, cols);
+  for (Index i = 0; i < rows; i++) {
+    A.row(i) *= std::pow(10., double(i % 7) * 20. - 60.);
+  }
+  return A;
+}
+
+// Largest error relative to the largest entries of the row of A and the
+// column of B, computed against an extended precision product
+double scaled_error(const Eigen::MatrixXd &A, const Eigen::MatrixXd &B,
+                    const Eigen::MatrixXd &C) {
+  MatrixXld exact = A.cast<long double>() * B.cast<long double>();
+  Eigen::VectorXd row_max = A.cwiseAbs().rowwise().maxCoeff();
+  Eigen::VectorXd col_max = B.cwiseAbs().colwise().maxCoeff().transpose();
+  double error = 0.;
+  for (Index j = 0; j < C.cols(); j++) {
+    for (Index i = 0; i < C.rows(); i++) {
+      double difference = double(std::abs(C(i, j) - exact(i, j)));
+      error = std::max(error, difference / (row_max(i) * col_max(j)));
+    }
+  }
+  return error;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(accuracy_targets) {
+  CpuPipeline cpu;
+  Eigen::MatrixXd A = graded(40, 300);
+  Eigen::MatrixXd B = graded(50, 300).transpose();
+  Eigen::MatrixXd C;
+
+  // Double precision accuracy, up to the rounding of the sums
+  cpu.gemm_split(A, B, C);
+  BOOST_TEST(scaled_error(A, B, C) < 1e-14);
+  double previous = 0.;
+  for (int bits : {40, 24, 12}) {
+    cpu.gemm_split(A, B, C, bits);
+    double error = scaled_error(A, B, C);
+    BOOST_TEST(error < std::ldexp(1., -bits));
+    BOOST_TEST(error >= previous);
+    previous = error;
+  }
+
+  // The narrower slices of the tensor cores reach the same accuracy
+  cpu.gemm_split(A, B, C, 53, SplitArithmetic::TensorFloat32);
+  BOOST_TEST(scaled_error(A, B, C) < 1e-14);
+}
+
+BOOST_AUTO_TEST_CASE(host_and_device_agree) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  Eigen::MatrixXd A = graded(33, 70);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(70, 21);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  CudaMatrix cuma_C{1, 1, cp.get_stream()};
+  Eigen::MatrixXd C;
+
+  for (int bits : {53, 30}) {
+    for (SplitArithmetic arithmetic :
+         {SplitArithmetic::Single, SplitArithmetic::TensorFloat32}) {
+      cp.gemm_split(cuma_A, cuma_B, cuma_C, bits, arithmetic);
+      cpu.gemm_split(A, B, C, bits, arithmetic);
+      BOOST_TEST((Eigen::MatrixXd(cuma_C).array() == C.array()).all());
+    }
+  }
+  BOOST_TEST(Eigen::MatrixXd(cuma_C).isApprox(A * B, 1e-6));
+
+  // Zero rows and columns have unit scales
+  A.row(3).setZero();
+  B.col(5).setZero();
+  cuma_A.copy_to_gpu(A);
+  cuma_B.copy_to_gpu(B);
+  cp.gemm_split(cuma_A, cuma_B, cuma_C);
+  Eigen::MatrixXd result = cuma_C;
+  BOOST_TEST(result.row(3).isZero(0.));
+  BOOST_TEST(result.col(5).isZero(0.));
+}
+
+BOOST_AUTO_TEST_CASE(split_gemm_in_workspace) {
+  CudaPipeline cp;
+  cp.reserve_workspace(1 << 20);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(20, 30);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(30, 10);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  CudaMatrix cuma_C{20, 10, cp.get_stream()};
+  cp.gemm_split(cuma_A, cuma_B, cuma_C);
+  BOOST_TEST(Eigen::MatrixXd(cuma_C).isApprox(A * B, 1e-14));
+  BOOST_TEST(cp.workspace().used() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_split_gemm) {
+  CudaPipeline cp;
+  CpuPipeline cpu;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(4, 5);
+  Eigen::MatrixXd C;
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_C{1, 1, cp.get_stream()};
+  BOOST_CHECK_THROW(cp.gemm_split(cuma_A, cuma_A, cuma_C),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cpu.gemm_split(A, A.transpose(), C, 0),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cpu.gemm_split(A, A.transpose(), C, 54),
+                    std::runtime_error);
+  eigencuda::RowMajorMatrixXd transposed = A.transpose();
+  CudaMatrix row_major{transposed, cp.get_stream()};
+  BOOST_CHECK_THROW(cp.gemm_split(row_major, cuma_A, cuma_C),
+                    std::runtime_error);
+}
@@ -0,0 +1,195 @@
+#define BOOST_TEST_MODULE storage_order
+
+#include "cudaexpression.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaSparseMatrix;
+using eigencuda::CudaVector;
+using eigencuda::MemoryKind;
+using eigencuda::Operation;
+using eigencuda::RowMajorMatrixXd;
+using eigencuda::StorageOrder;
+using eigencuda::Triangle;
+
+namespace {
+CudaMatrix row_major_matrix(const CudaPipeline &cp) {
+  return CudaMatrix{1, 1, cp.get_stream(), MemoryKind::Device,
+                    StorageOrder::RowMajor};
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(row_major_transfers) {
+  CudaPipeline cp;
+  RowMajorMatrixXd A = RowMajorMatrixXd::Random(7, 4);
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  BOOST_TEST((cuma_A.storage_order() == StorageOrder::RowMajor));
+  BOOST_TEST(cuma_A.leading_dimension() == 4);
+
+  // Download in both storage orders
+  RowMajorMatrixXd row_major = cuma_A;
+  Eigen::MatrixXd col_major = cuma_A;
+  BOOST_TEST(row_major.isApprox(A));
+  BOOST_TEST(col_major.isApprox(Eigen::MatrixXd(A)));
+
+  // Uploads switch the storage order of the device matrix
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(3, 5);
+  cp.copy_to_gpu(B, cuma_A);
+  BOOST_TEST((cuma_A.storage_order() == StorageOrder::ColMajor));
+  cp.copy_to_gpu(A, cuma_A);
+  BOOST_TEST((cuma_A.storage_order() == StorageOrder::RowMajor));
+  Eigen::MatrixXd result;
+  cp.copy_to_host(cuma_A, result);
+  BOOST_TEST(result.isApprox(Eigen::MatrixXd(A)));
+
+  // Expressions are evaluated in their own storage order
+  CudaMatrix cuma_B{2. * B, cp.get_stream()};
+  CudaMatrix cuma_At{A.transpose(), cp.get_stream()};
+  BOOST_TEST((cuma_B.storage_order() == StorageOrder::ColMajor));
+  BOOST_TEST((cuma_At.storage_order() == StorageOrder::ColMajor));
+  BOOST_TEST((2. * B).isApprox(Eigen::MatrixXd(cuma_B)));
+  BOOST_TEST(A.transpose().isApprox(Eigen::MatrixXd(cuma_At)));
+}
+
+BOOST_AUTO_TEST_CASE(mixed_order_gemm) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(6, 9);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(9, 5);
+  RowMajorMatrixXd row_A = A;
+  RowMajorMatrixXd row_B = B;
+
+  CudaMatrix col_cuma_A{A, cp.get_stream()};
+  CudaMatrix col_cuma_B{B, cp.get_stream()};
+  CudaMatrix row_cuma_A{row_A, cp.get_stream()};
+  CudaMatrix row_cuma_B{row_B, cp.get_stream()};
+  const CudaMatrix *lhs[] = {&col_cuma_A, &row_cuma_A};
+  const CudaMatrix *rhs[] = {&col_cuma_B, &row_cuma_B};
+
+  Eigen::MatrixXd expected = A * B;
+  for (const CudaMatrix *cuma_A : lhs) {
+    for (const CudaMatrix *cuma_B : rhs) {
+      CudaMatrix col_C{1, 1, cp.get_stream()};
+      CudaMatrix row_C = row_major_matrix(cp);
+      cp.gemm(*cuma_A, *cuma_B, col_C);
+      cp.gemm(*cuma_A, *cuma_B, row_C);
+      BOOST_TEST((row_C.storage_order() == StorageOrder::RowMajor));
+      BOOST_TEST(expected.isApprox(Eigen::MatrixXd(col_C)));
+      BOOST_TEST(expected.isApprox(Eigen::MatrixXd(row_C)));
+
+      // Transposed operands
+      cp.gemm(*cuma_B, *cuma_A, row_C, 2., 0., Operation::Transpose,
+              Operation::Transpose);
+      Eigen::MatrixXd transposed = 2. * expected.transpose();
+      BOOST_TEST(transposed.isApprox(Eigen::MatrixXd(row_C)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mixed_order_geam_and_copy) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(8, 3);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(8, 3);
+  RowMajorMatrixXd row_B = B;
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaMatrix cuma_B{row_B, cp.get_stream()};
+
+  CudaMatrix row_C = row_major_matrix(cp);
+  cp.geam(cuma_A, cuma_B, row_C, 1., -2.);
+  BOOST_TEST((A - 2. * B).isApprox(Eigen::MatrixXd(row_C)));
+
+  CudaMatrix col_C{1, 1, cp.get_stream()};
+  cp.geam(cuma_B, cuma_A, col_C, 1., 1., Operation::Transpose,
+          Operation::Transpose);
+  BOOST_TEST((A + B).transpose().isApprox(Eigen::MatrixXd(col_C)));
+
+  // The copy keeps the storage order of the destination
+  cp.copy(cuma_B, col_C);
+  BOOST_TEST((col_C.storage_order() == StorageOrder::ColMajor));
+  BOOST_TEST(B.isApprox(Eigen::MatrixXd(col_C)));
+
+  // Element-wise kernels need a common storage order
+  BOOST_CHECK_THROW(cp.axpy(1., cuma_A, cuma_B), std::runtime_error);
+  cp.hadamard_product(cuma_B, cuma_B, col_C);
+  BOOST_TEST((col_C.storage_order() == StorageOrder::RowMajor));
+  BOOST_TEST(B.cwiseProduct(B).isApprox(Eigen::MatrixXd(col_C)));
+}
+
+BOOST_AUTO_TEST_CASE(row_major_products) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(10, 10);
+  Eigen::MatrixXd S = A + A.transpose();
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(10, 4);
+  Eigen::VectorXd x = Eigen::VectorXd::Random(10);
+  RowMajorMatrixXd row_A = A;
+  RowMajorMatrixXd row_S = S;
+  RowMajorMatrixXd row_B = B;
+  CudaMatrix cuma_A{row_A, cp.get_stream()};
+  CudaMatrix cuma_S{row_S, cp.get_stream()};
+  CudaMatrix cuma_B{row_B, cp.get_stream()};
+  CudaVector cuda_x{x, cp.get_stream()};
+
+  CudaVector cuda_y{1, cp.get_stream()};
+  cp.gemv(cuma_A, cuda_x, cuda_y);
+  BOOST_TEST((A * x).isApprox(Eigen::VectorXd(cuda_y)));
+  cp.gemv(cuma_A, cuda_x, cuda_y, 1., 0., Operation::Transpose);
+  BOOST_TEST((A.transpose() * x).isApprox(Eigen::VectorXd(cuda_y)));
+
+  CudaMatrix C = row_major_matrix(cp);
+  cp.symm(cuma_S, cuma_B, C);
+  BOOST_TEST((S * B).isApprox(Eigen::MatrixXd(C)));
+
+  cp.syrk(cuma_B, C, Triangle::Lower);
+  Eigen::MatrixXd gram = B.transpose() * B;
+  Eigen::MatrixXd lower = cp.copy_symmetric_to_host(C, Triangle::Lower);
+  BOOST_TEST(gram.isApprox(lower));
+  RowMajorMatrixXd stored = C;
+  BOOST_TEST(stored.triangularView<Eigen::Lower>().toDenseMatrix().isApprox(
+      gram.triangularView<Eigen::Lower>().toDenseMatrix()));
+
+  Eigen::SparseMatrix<double> sparse = A.sparseView();
+  CudaSparseMatrix cuda_sparse{sparse, cp.get_stream()};
+  cp.spmm(cuda_sparse, cuma_B, C);
+  BOOST_TEST((A * B).isApprox(Eigen::MatrixXd(C)));
+}
+
+BOOST_AUTO_TEST_CASE(row_major_solvers) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(12, 12);
+  Eigen::MatrixXd S =
+      A * A.transpose() + 12. * Eigen::MatrixXd::Identity(12, 12);
+  RowMajorMatrixXd row_S = S;
+  CudaMatrix cuma_S{row_S, cp.get_stream()};
+
+  CudaMatrix values{1, 1, cp.get_stream()};
+  CudaMatrix vectors = row_major_matrix(cp);
+  cp.syevd(cuma_S, values, vectors);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(S);
+  BOOST_TEST(solver.eigenvalues().isApprox(Eigen::MatrixXd(values)));
+
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(12, 2);
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  eigencuda::CholeskyFactor factor = cp.potrf(cuma_S);
+  cp.potrs(factor, cuma_B);
+  BOOST_TEST(S.llt().solve(B).isApprox(Eigen::MatrixXd(cuma_B)));
+
+  RowMajorMatrixXd row_B = B;
+  CudaMatrix row_cuma_B{row_B, cp.get_stream()};
+  BOOST_CHECK_THROW(cp.potrs(factor, row_cuma_B), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(row_major_expression) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(5, 7);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(7, 5);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(5, 5);
+  RowMajorMatrixXd row_A = A;
+  CudaMatrix cuma_A{row_A, cp.get_stream()};
+  CudaMatrix cuma_B{B, cp.get_stream()};
+  CudaMatrix cuma_C{C, cp.get_stream()};
+  CudaMatrix D = row_major_matrix(cp);
+
+  eigencuda::evaluate(cp, cuma_A * cuma_B + 2. * cuma_C, D);
+  BOOST_TEST((A * B + 2. * C).isApprox(Eigen::MatrixXd(D)));
+}
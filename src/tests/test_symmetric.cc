@@ -0,0 +1,107 @@
+#define BOOST_TEST_MODULE symmetric
+
+#include "cpupipeline.hpp"
+#include "cudapipeline.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CpuPipeline;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Operation;
+using eigencuda::Side;
+using eigencuda::Triangle;
+
+BOOST_AUTO_TEST_CASE(gram_matrix) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(40, 25);
+  Eigen::MatrixXd gram = A.transpose() * A;
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_C{1, 1, cuda_pip.get_stream()};
+  Eigen::MatrixXd C;
+
+  cuda_pip.syrk(cuma_A, cuma_C);
+  BOOST_TEST(gram.isApprox(Eigen::MatrixXd(cuma_C)));
+  cpu_pip.syrk(A, C);
+  BOOST_TEST(gram.isApprox(C));
+
+  // Gram matrix of the rows
+  cuda_pip.syrk(cuma_A, cuma_C, Triangle::Full, Operation::None);
+  BOOST_TEST((A * A.transpose()).isApprox(Eigen::MatrixXd(cuma_C)));
+  cpu_pip.syrk(A, C, Triangle::Full, Operation::None);
+  BOOST_TEST((A * A.transpose()).isApprox(C));
+}
+
+BOOST_AUTO_TEST_CASE(single_triangle) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(30, 20);
+  Eigen::MatrixXd gram = A.transpose() * A;
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_C{1, 1, cuda_pip.get_stream()};
+  Eigen::MatrixXd C;
+
+  for (Triangle triangle : {Triangle::Lower, Triangle::Upper}) {
+    cuda_pip.syrk(cuma_A, cuma_C, triangle);
+    // Only half of the matrix is transferred
+    BOOST_TEST(
+        gram.isApprox(cuda_pip.copy_symmetric_to_host(cuma_C, triangle)));
+
+    cpu_pip.syrk(A, C, triangle);
+    Eigen::MatrixXd full = C + C.transpose();
+    full.diagonal() /= 2.;
+    BOOST_TEST(gram.isApprox(full));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(rank_2k_update) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(30, 20);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(30, 20);
+  Eigen::MatrixXd expected = A.transpose() * B + B.transpose() * A;
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+  CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+  CudaMatrix cuma_C{1, 1, cuda_pip.get_stream()};
+  Eigen::MatrixXd C;
+
+  cuda_pip.syr2k(cuma_A, cuma_B, cuma_C);
+  BOOST_TEST(expected.isApprox(Eigen::MatrixXd(cuma_C)));
+  cpu_pip.syr2k(A, B, C);
+  BOOST_TEST(expected.isApprox(C));
+
+  cuda_pip.syr2k(cuma_A, cuma_B, cuma_C, Triangle::Upper);
+  BOOST_TEST(expected.isApprox(
+      cuda_pip.copy_symmetric_to_host(cuma_C, Triangle::Upper)));
+}
+
+BOOST_AUTO_TEST_CASE(symmetric_times_general) {
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(15, 15);
+  Eigen::MatrixXd S = M + M.transpose();
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(15, 8);
+
+  CudaPipeline cuda_pip;
+  CpuPipeline cpu_pip;
+  CudaMatrix cuma_S{S, cuda_pip.get_stream()};
+  CudaMatrix cuma_B{B, cuda_pip.get_stream()};
+  CudaMatrix cuma_C{1, 1, cuda_pip.get_stream()};
+  Eigen::MatrixXd C;
+
+  cuda_pip.symm(cuma_S, cuma_B, cuma_C);
+  BOOST_TEST((S * B).isApprox(Eigen::MatrixXd(cuma_C)));
+  cpu_pip.symm(S, B, C);
+  BOOST_TEST((S * B).isApprox(C));
+
+  Eigen::MatrixXd Bt = B.transpose();
+  CudaMatrix cuma_Bt{Bt, cuda_pip.get_stream()};
+  cuda_pip.symm(cuma_S, cuma_Bt, cuma_C, Side::Right);
+  BOOST_TEST((Bt * S).isApprox(Eigen::MatrixXd(cuma_C)));
+  cpu_pip.symm(S, Bt, C, Side::Right);
+  BOOST_TEST((Bt * S).isApprox(C));
+
+  BOOST_REQUIRE_THROW(cuda_pip.symm(cuma_S, cuma_Bt, cuma_C),
+                      std::runtime_error);
+}
@@ -0,0 +1,94 @@
+#define BOOST_TEST_MODULE tensor
+
+#include "cudapipeline.hpp"
+#include "cudatensor.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::CudaTensor;
+using eigencuda::Index;
+
+BOOST_AUTO_TEST_CASE(bulk_transfers) {
+  CudaPipeline cp;
+  std::vector<Eigen::MatrixXd> matrices;
+  for (Index i = 0; i < 4; i++) {
+    matrices.push_back(Eigen::MatrixXd::Random(5, 3));
+  }
+  CudaTensor tensor{matrices, cp.get_stream()};
+  BOOST_TEST(tensor.rows() == 5);
+  BOOST_TEST(tensor.cols() == 3);
+  BOOST_TEST(tensor.depth() == 4);
+
+  std::vector<Eigen::MatrixXd> result = tensor;
+  BOOST_TEST(result.size() == 4);
+  for (Index i = 0; i < 4; i++) {
+    BOOST_TEST(matrices[i].isApprox(result[i]));
+    BOOST_TEST(matrices[i].isApprox(Eigen::MatrixXd(tensor.slice(i))));
+  }
+
+  // Contiguous host buffer, e.g. an Eigen::Tensor
+  Eigen::VectorXd buffer = Eigen::VectorXd::Random(2 * 6 * 3);
+  tensor.copy_to_gpu(buffer.data(), 2, 6, 3);
+  BOOST_TEST(tensor.rows() == 2);
+  Eigen::VectorXd downloaded(buffer.size());
+  tensor.copy_to_host(downloaded.data());
+  BOOST_TEST(buffer.isApprox(downloaded));
+  BOOST_TEST(Eigen::MatrixXd(tensor.matrix())
+                 .isApprox(Eigen::Map<Eigen::MatrixXd>(buffer.data(), 2, 18)));
+
+  BOOST_CHECK_THROW(tensor.slice(3), std::runtime_error);
+  matrices.push_back(Eigen::MatrixXd::Random(3, 5));
+  BOOST_CHECK_THROW(tensor.copy_to_gpu(matrices), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(slices_in_gemm) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(3, 3);
+  std::vector<Eigen::MatrixXd> matrices{Eigen::MatrixXd::Random(3, 3),
+                                        Eigen::MatrixXd::Random(3, 3)};
+  CudaTensor tensor{matrices, cp.get_stream()};
+  CudaMatrix cuma_A{A, cp.get_stream()};
+
+  // Write the product of the slices into the first one
+  CudaMatrix first = tensor.slice(0);
+  cp.gemm(tensor.slice(1), cuma_A, first);
+  std::vector<Eigen::MatrixXd> result = tensor;
+  BOOST_TEST(result[0].isApprox(matrices[1] * A));
+  BOOST_TEST(result[1].isApprox(matrices[1]));
+
+  // A slice cannot leave the tensor for a bigger buffer
+  BOOST_TEST(!first.owns_memory());
+  CudaMatrix wide{Eigen::MatrixXd::Random(3, 6), cp.get_stream()};
+  BOOST_CHECK_THROW(cp.gemm(tensor.slice(1), wide, first), std::runtime_error);
+  BOOST_CHECK_THROW(first.shrink_to_fit(), std::runtime_error);
+  first.resize(2, 3);
+  BOOST_TEST(first.data() == tensor.data());
+}
+
+BOOST_AUTO_TEST_CASE(tensor_matrix_products) {
+  CudaPipeline cp;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Zero(2, 2);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Zero(3, 2);
+  Eigen::MatrixXd C = Eigen::MatrixXd::Zero(3, 2);
+  Eigen::MatrixXd D = Eigen::MatrixXd::Zero(3, 2);
+  A << 1., 2., 3., 4.;
+  B << 5., 6., 7., 8., 9., 10.;
+  C << 9., 10., 11., 12., 13., 14.;
+  D << 13., 14., 15., 16., 17., 18.;
+
+  CudaTensor tensor{{B, C, D}, cp.get_stream()};
+  CudaMatrix cuma_A{A, cp.get_stream()};
+  CudaTensor products{1, 1, 1, cp.get_stream()};
+  cp.gemm(tensor, cuma_A, products);
+  std::vector<Eigen::MatrixXd> result = products;
+  BOOST_TEST(result[0].isApprox(B * A));
+  BOOST_TEST(result[1].isApprox(C * A));
+  BOOST_TEST(result[2].isApprox(D * A));
+
+  // The same product as a contraction over the tensor
+  CudaMatrix contracted{1, 1, cp.get_stream()};
+  cp.einsum("ijP,jk->ikP", {tensor, cuma_A}, contracted);
+  BOOST_TEST(Eigen::MatrixXd(contracted)
+                 .isApprox(Eigen::MatrixXd(products.matrix())));
+}
@@ -0,0 +1,86 @@
+#define BOOST_TEST_MODULE transfers
+
+#include "cudapipeline.hpp"
+#include "matrixloader.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <fstream>
+
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Index;
+using eigencuda::StagingRing;
+
+namespace {
+std::string write_binary(const Eigen::MatrixXd &A, const std::string &name) {
+  std::ofstream out(name, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(A.data()),
+            A.size() * sizeof(double));
+  return name;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(staging_ring_upload) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(100, 37);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{100, 37, cuda_pip.get_stream()};
+
+  // Chunks much smaller than the matrix force several turns of the ring
+  StagingRing ring{2, 1000};
+  ring.upload(cuma_A.data(), A.data(), A.size() * sizeof(double),
+              cuda_pip.get_stream());
+
+  BOOST_TEST(A.isApprox(Eigen::MatrixXd(cuma_A)));
+  BOOST_REQUIRE_THROW(StagingRing(1, 1000), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(load_matrix_from_file) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(300, 200);
+  std::string name = write_binary(A, "load_matrix_from_file.bin");
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A = eigencuda::load_matrix(name, 300, 200, cuda_pip);
+  BOOST_TEST(A.isApprox(Eigen::MatrixXd(cuma_A)));
+
+  BOOST_REQUIRE_THROW(eigencuda::load_matrix(name, 300, 300, cuda_pip),
+                      std::runtime_error);
+  BOOST_REQUIRE_THROW(eigencuda::load_matrix("missing.bin", 2, 2, cuda_pip),
+                      std::runtime_error);
+  std::remove(name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(staging_ring_download) {
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(100, 37);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{A, cuda_pip.get_stream()};
+
+  StagingRing ring{3, 1000};
+  Eigen::MatrixXd B = Eigen::MatrixXd::Zero(100, 37);
+  ring.download(B.data(), cuma_A.data(), A.size() * sizeof(double),
+                cuda_pip.get_stream());
+
+  BOOST_TEST(A.isApprox(B));
+}
+
+BOOST_AUTO_TEST_CASE(pipeline_pageable_transfers) {
+  // Large enough to go through the staging ring
+  Index dim = 1000;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim);
+
+  CudaPipeline cuda_pip;
+  CudaMatrix cuma_A{1, 1, cuda_pip.get_stream()};
+  cuda_pip.copy_to_gpu(A, cuma_A);
+  BOOST_TEST(cuma_A.rows() == dim);
+
+  Eigen::MatrixXd B;
+  cuda_pip.copy_to_host(cuma_A, B);
+  BOOST_TEST(A.isApprox(B));
+
+  // Small matrices are copied directly
+  Eigen::MatrixXd C = Eigen::MatrixXd::Random(3, 2);
+  cuda_pip.copy_to_gpu(C, cuma_A);
+  cuda_pip.copy_to_host(cuma_A, B);
+  BOOST_TEST(C.isApprox(B));
+}
@@ -0,0 +1,73 @@
+#define BOOST_TEST_MODULE workspace
+
+#include "cudapipeline.hpp"
+#include "workspace.hpp"
+#include <boost/test/unit_test.hpp>
+
+using eigencuda::Arena;
+using eigencuda::CudaMatrix;
+using eigencuda::CudaPipeline;
+using eigencuda::Index;
+using eigencuda::Workspace;
+
+BOOST_AUTO_TEST_CASE(arena_alignment) {
+  Arena arena{1024, 64};
+
+  BOOST_TEST(arena.allocate(10) == 0);
+  BOOST_TEST(arena.allocate(8) == 64);
+  BOOST_TEST(arena.allocate(64) == 128);
+  BOOST_TEST(arena.used() == 192);
+
+  BOOST_REQUIRE_THROW(Arena(1024, 48), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(arena_release_and_high_water_mark) {
+  Arena arena{1024, 64};
+
+  arena.allocate(100);
+  size_t mark = arena.mark();
+  arena.allocate(500);
+  arena.allocate(100);
+  BOOST_TEST(arena.high_water_mark() == 740);
+
+  arena.release(mark);
+  BOOST_TEST(arena.used() == 100);
+  BOOST_TEST(arena.allocate(10) == 128);
+  BOOST_TEST(arena.high_water_mark() == 740);
+
+  arena.reset();
+  BOOST_TEST(arena.used() == 0);
+  BOOST_REQUIRE_THROW(arena.release(64), std::runtime_error);
+  BOOST_REQUIRE_THROW(arena.allocate(2048), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(workspace_scope) {
+  Index dim = 20;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Random(dim, dim);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, dim);
+
+  CudaPipeline cuda_pip;
+  cuda_pip.reserve_workspace(4 * dim * dim * sizeof(double));
+  Workspace &workspace = cuda_pip.workspace();
+
+  Eigen::MatrixXd C;
+  {
+    Workspace::Scope scope{workspace};
+    CudaMatrix cuma_A = workspace.matrix(dim, dim);
+    CudaMatrix cuma_B = workspace.matrix(dim, dim);
+    CudaMatrix cuma_C = workspace.matrix(dim, dim);
+    cuma_A.copy_to_gpu(A);
+    cuma_B.copy_to_gpu(B);
+    cuda_pip.gemm(cuma_A, cuma_B, cuma_C);
+    C = cuma_C;
+
+    // The views stay inside the block they were taken from
+    CudaMatrix columns = cuma_C.middle_cols(0, 2);
+    BOOST_CHECK_THROW(columns.resize(dim, 3), std::runtime_error);
+    BOOST_CHECK_THROW(cuma_C.resize(dim + 1, dim), std::runtime_error);
+  }
+
+  BOOST_TEST(C.isApprox(A * B));
+  BOOST_TEST(workspace.used() == 0);
+  BOOST_TEST(workspace.high_water_mark() >= 3 * dim * dim * sizeof(double));
+}
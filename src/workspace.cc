@@ -0,0 +1,59 @@
+#include "workspace.hpp"
+
+namespace eigencuda {
+
+Arena::Arena(size_t capacity, size_t alignment)
+    : _capacity{capacity}, _alignment{alignment} {
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    throw std::runtime_error("The arena alignment must be a power of two");
+  }
+}
+
+size_t Arena::allocate(size_t bytes) {
+  size_t offset = (_offset + _alignment - 1) & ~(_alignment - 1);
+  if (offset + bytes > _capacity) {
+    std::ostringstream oss;
+    oss << "There were requested : " << bytes << " bytes from the workspace\n"
+        << "Workspace used memory (bytes): " << _offset
+        << "\nWorkspace capacity (bytes): " << _capacity << "\n";
+    throw std::runtime_error(oss.str());
+  }
+  _offset = offset + bytes;
+  _high_water_mark = std::max(_high_water_mark, _offset);
+  return offset;
+}
+
+void Arena::release(size_t mark) {
+  if (mark > _offset) {
+    throw std::runtime_error("Cannot release memory that was never allocated");
+  }
+  _offset = mark;
+}
+
+Workspace::Workspace(size_t capacity, const cudaStream_t &stream)
+    : _arena{capacity}, _stream{stream} {
+  char *block;
+  if (checkCuda(cudaMalloc(&block, capacity)) != cudaSuccess) {
+    std::ostringstream oss;
+    oss << "Could not reserve a workspace of " << capacity
+        << " bytes in the device\n";
+    throw std::runtime_error(oss.str());
+  }
+  _block.reset(block);
+}
+
+CudaMatrix Workspace::matrix(Index nrows, Index ncols) {
+  size_t offset = _arena.allocate(nrows * ncols * sizeof(double));
+  double *data = reinterpret_cast<double *>(_block.get() + offset);
+  return CudaMatrix{data, nrows, ncols, _stream};
+}
+
+std::ostream &operator<<(std::ostream &os, const Workspace &workspace) {
+  os << "Workspace capacity (bytes): " << workspace.capacity()
+     << "\nWorkspace used memory (bytes): " << workspace.used()
+     << "\nWorkspace high water mark (bytes): " << workspace.high_water_mark()
+     << "\n";
+  return os;
+}
+
+}  // namespace eigencuda